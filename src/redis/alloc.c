@@ -0,0 +1,49 @@
+/*
+ * FileName : alloc.c
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 09 Nov 2026 03:05:42 PM CST   Created
+*/
+
+#include "fmacros.h"
+#include "alloc.h"
+#include <string.h>
+#include <stdlib.h>
+
+hiredisAllocFuncs hiredisAllocFns = {
+    .mallocFn = malloc,
+    .callocFn = calloc,
+    .reallocFn = realloc,
+    .strdupFn = strdup,
+    .freeFn = free,
+};
+
+hiredisGoodSizeFn hiredisGoodSize = NULL;
+
+/* Override hiredis' allocators with ones supplied by the user */
+hiredisAllocFuncs hiredisSetAllocators(hiredisAllocFuncs *override) {
+    hiredisAllocFuncs orig = hiredisAllocFns;
+
+    hiredisAllocFns = *override;
+
+    return orig;
+}
+
+/* Reset allocators to use libc defaults */
+void hiredisResetAllocators(void) {
+    hiredisAllocFns = (hiredisAllocFuncs) {
+        .mallocFn = malloc,
+        .callocFn = calloc,
+        .reallocFn = realloc,
+        .strdupFn = strdup,
+        .freeFn = free,
+    };
+    hiredisGoodSize = NULL;
+}
+
+hiredisGoodSizeFn hiredisSetGoodSize(hiredisGoodSizeFn fn) {
+    hiredisGoodSizeFn orig = hiredisGoodSize;
+
+    hiredisGoodSize = fn;
+
+    return orig;
+}
@@ -0,0 +1,77 @@
+/*
+ * FileName : alloc.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 09 Nov 2026 03:05:42 PM CST   Created
+*/
+
+/*
+ * hiredis 的内存分配接口, 与上游 hiredis 1.x 的 alloc.h 同名同义, 升级时可以直接替换.
+ * hiredis.c/net.c/read.c/sds.c 以及 PRedisReplyPool 的分配都经过这里.
+ * hiredisSetAllocators 需要在创建任何 context 之前调用, 或者保证新旧分配器
+ * 能释放对方分配的内存 (例如只做计数的包装).
+ */
+
+#ifndef __HIREDIS_ALLOC_H
+#define __HIREDIS_ALLOC_H
+
+#include <stddef.h> /* for size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct hiredisAllocFuncs {
+    void *(*mallocFn)(size_t);
+    void *(*callocFn)(size_t,size_t);
+    void *(*reallocFn)(void*,size_t);
+    char *(*strdupFn)(const char*);
+    void (*freeFn)(void*);
+} hiredisAllocFuncs;
+
+/* Replace the allocators and return the previous set. */
+hiredisAllocFuncs hiredisSetAllocators(hiredisAllocFuncs *fns);
+void hiredisResetAllocators(void);
+
+extern hiredisAllocFuncs hiredisAllocFns;
+
+/* 以下不在上游接口中: 分配器对 size 字节的请求实际给出的大小 (所在的 size class),
+ * sdsMakeRoomFor 按它扩容, 不浪费分配器给出的尾部空间. NULL 时原样返回,
+ * hiredisResetAllocators 时恢复为 NULL */
+typedef size_t (*hiredisGoodSizeFn)(size_t);
+hiredisGoodSizeFn hiredisSetGoodSize(hiredisGoodSizeFn fn);
+
+extern hiredisGoodSizeFn hiredisGoodSize;
+
+static inline void *hi_malloc(size_t size) {
+    return hiredisAllocFns.mallocFn(size);
+}
+
+static inline void *hi_calloc(size_t nmemb, size_t size) {
+    /* Overflow check as the user can specify any arbitrary allocator */
+    if (size != 0 && nmemb > (size_t)-1 / size)
+        return NULL;
+
+    return hiredisAllocFns.callocFn(nmemb, size);
+}
+
+static inline void *hi_realloc(void *ptr, size_t size) {
+    return hiredisAllocFns.reallocFn(ptr, size);
+}
+
+static inline char *hi_strdup(const char *str) {
+    return hiredisAllocFns.strdupFn(str);
+}
+
+static inline void hi_free(void *ptr) {
+    hiredisAllocFns.freeFn(ptr);
+}
+
+static inline size_t hi_good_size(size_t size) {
+    return hiredisGoodSize != NULL ? hiredisGoodSize(size) : size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HIREDIS_ALLOC_H */
@@ -42,8 +42,18 @@
 #include "hiredis.h"
 #include "net.h"
 #include "sds.h"
-
-static redisReply *createReplyObject(int type);
+#include "p_redis_probe.h"
+
+/* USDT semaphores, shared with net.c and PRedisClient */
+PREDIS_PROBE_DEFINE(connect);
+PREDIS_PROBE_DEFINE(reconnect);
+PREDIS_PROBE_DEFINE(append);
+PREDIS_PROBE_DEFINE(write);
+PREDIS_PROBE_DEFINE(read);
+PREDIS_PROBE_DEFINE(reply);
+PREDIS_PROBE_DEFINE(command);
+
+static redisReply *createReplyObject(int type, size_t extra);
 static void *createStringObject(const redisReadTask *task, char *str, size_t len);
 static void *createArrayObject(const redisReadTask *task, int elements);
 static void *createIntegerObject(const redisReadTask *task, long long value);
@@ -59,9 +69,37 @@ static redisReplyObjectFunctions defaultFunctions = {
     freeReplyObject
 };
 
-/* Create a reply object */
-static redisReply *createReplyObject(int type) {
-    redisReply *r = calloc(1,sizeof(*r));
+/* Replies that are common enough to be served from static storage. */
+static const struct {
+    int type;
+    const char *str;
+    size_t len;
+} sharedReplies[] = {
+    { REDIS_REPLY_STATUS, "OK", 2 },
+    { REDIS_REPLY_STATUS, "QUEUED", 6 },
+    { REDIS_REPLY_STATUS, "PONG", 4 },
+    { REDIS_REPLY_STATUS, "string", 6 },
+    { REDIS_REPLY_STATUS, "none", 4 },
+    { REDIS_REPLY_ERROR, "BUSYGROUP Consumer Group name already exists", 44 },
+    { REDIS_REPLY_ERROR, "NOSCRIPT No matching script. Please use EVAL.", 45 },
+    { REDIS_REPLY_ERROR, "WRONGTYPE Operation against a key holding the wrong kind of value", 65 },
+    { REDIS_REPLY_ERROR, "EXECABORT Transaction discarded because of previous errors.", 59 }
+};
+
+static const char *sharedReplyString(int type, const char *str, size_t len) {
+    size_t j;
+
+    for (j = 0; j < sizeof(sharedReplies)/sizeof(sharedReplies[0]); j++) {
+        if (sharedReplies[j].type == type && sharedReplies[j].len == len &&
+            memcmp(sharedReplies[j].str,str,len) == 0)
+            return sharedReplies[j].str;
+    }
+    return NULL;
+}
+
+/* Create a reply object, with extra bytes after it for an inline string */
+static redisReply *createReplyObject(int type, size_t extra) {
+    redisReply *r = hi_calloc(1,sizeof(*r)+extra);
 
     if (r == NULL)
         return NULL;
@@ -86,41 +124,60 @@ void freeReplyObject(void *reply) {
             for (j = 0; j < r->elements; j++)
                 if (r->element[j] != NULL)
                     freeReplyObject(r->element[j]);
-            free(r->element);
+            hi_free(r->element);
         }
         break;
     case REDIS_REPLY_ERROR:
     case REDIS_REPLY_STATUS:
     case REDIS_REPLY_STRING:
-        if (r->str != NULL)
-            free(r->str);
+        if (r->str != NULL && !(r->flags & (REDIS_REPLY_STR_INLINE|REDIS_REPLY_STR_STATIC)))
+            hi_free(r->str);
         break;
     }
-    free(r);
+    hi_free(r);
 }
 
 static void *createStringObject(const redisReadTask *task, char *str, size_t len) {
     redisReply *r, *parent;
+    const char *shared = NULL;
     char *buf;
 
-    r = createReplyObject(task->type);
-    if (r == NULL)
-        return NULL;
-
-    buf = malloc(len+1);
-    if (buf == NULL) {
-        freeReplyObject(r);
-        return NULL;
-    }
-
     assert(task->type == REDIS_REPLY_ERROR  ||
            task->type == REDIS_REPLY_STATUS ||
            task->type == REDIS_REPLY_STRING);
 
-    /* Copy string value */
-    memcpy(buf,str,len);
-    buf[len] = '\0';
-    r->str = buf;
+    if (task->type != REDIS_REPLY_STRING)
+        shared = sharedReplyString(task->type,str,len);
+
+    if (shared != NULL) {
+        r = createReplyObject(task->type,0);
+        if (r == NULL)
+            return NULL;
+        r->flags = REDIS_REPLY_STR_STATIC;
+        r->str = (char*)shared;
+    } else if (len <= REDIS_REPLY_INLINE_MAX) {
+        r = createReplyObject(task->type,len+1);
+        if (r == NULL)
+            return NULL;
+        r->flags = REDIS_REPLY_STR_INLINE;
+        r->str = (char*)(r+1);
+        memcpy(r->str,str,len);
+    } else {
+        r = createReplyObject(task->type,0);
+        if (r == NULL)
+            return NULL;
+
+        buf = hi_malloc(len+1);
+        if (buf == NULL) {
+            freeReplyObject(r);
+            return NULL;
+        }
+
+        /* Copy string value */
+        memcpy(buf,str,len);
+        buf[len] = '\0';
+        r->str = buf;
+    }
     r->len = len;
 
     if (task->parent) {
@@ -134,12 +191,12 @@ static void *createStringObject(const redisReadTask *task, char *str, size_t len
 static void *createArrayObject(const redisReadTask *task, int elements) {
     redisReply *r, *parent;
 
-    r = createReplyObject(REDIS_REPLY_ARRAY);
+    r = createReplyObject(REDIS_REPLY_ARRAY,0);
     if (r == NULL)
         return NULL;
 
     if (elements > 0) {
-        r->element = calloc(elements,sizeof(redisReply*));
+        r->element = hi_calloc(elements,sizeof(redisReply*));
         if (r->element == NULL) {
             freeReplyObject(r);
             return NULL;
@@ -159,7 +216,7 @@ static void *createArrayObject(const redisReadTask *task, int elements) {
 static void *createIntegerObject(const redisReadTask *task, long long value) {
     redisReply *r, *parent;
 
-    r = createReplyObject(REDIS_REPLY_INTEGER);
+    r = createReplyObject(REDIS_REPLY_INTEGER,0);
     if (r == NULL)
         return NULL;
 
@@ -176,7 +233,7 @@ static void *createIntegerObject(const redisReadTask *task, long long value) {
 static void *createNilObject(const redisReadTask *task) {
     redisReply *r, *parent;
 
-    r = createReplyObject(REDIS_REPLY_NIL);
+    r = createReplyObject(REDIS_REPLY_NIL,0);
     if (r == NULL)
         return NULL;
 
@@ -232,7 +289,7 @@ int redisvFormatCommand(char **target, const char *format, va_list ap) {
         if (*c != '%' || c[1] == '\0') {
             if (*c == ' ') {
                 if (touched) {
-                    newargv = realloc(curargv,sizeof(char*)*(argc+1));
+                    newargv = hi_realloc(curargv,sizeof(char*)*(argc+1));
                     if (newargv == NULL) goto memory_err;
                     curargv = newargv;
                     curargv[argc++] = curarg;
@@ -381,7 +438,7 @@ int redisvFormatCommand(char **target, const char *format, va_list ap) {
 
     /* Add the last argument if needed */
     if (touched) {
-        newargv = realloc(curargv,sizeof(char*)*(argc+1));
+        newargv = hi_realloc(curargv,sizeof(char*)*(argc+1));
         if (newargv == NULL) goto memory_err;
         curargv = newargv;
         curargv[argc++] = curarg;
@@ -397,7 +454,7 @@ int redisvFormatCommand(char **target, const char *format, va_list ap) {
     totlen += 1+countDigits(argc)+2;
 
     /* Build the command at protocol level */
-    cmd = malloc(totlen+1);
+    cmd = hi_malloc(totlen+1);
     if (cmd == NULL) goto memory_err;
 
     pos = sprintf(cmd,"*%d\r\n",argc);
@@ -412,7 +469,7 @@ int redisvFormatCommand(char **target, const char *format, va_list ap) {
     assert(pos == totlen);
     cmd[pos] = '\0';
 
-    free(curargv);
+    hi_free(curargv);
     *target = cmd;
     return totlen;
 
@@ -428,7 +485,7 @@ cleanup:
     if (curargv) {
         while(argc--)
             sdsfree(curargv[argc]);
-        free(curargv);
+        hi_free(curargv);
     }
 
     sdsfree(curarg);
@@ -436,7 +493,7 @@ cleanup:
     /* No need to check cmd since it is the last statement that can fail,
      * but do it anyway to be as defensive as possible. */
     if (cmd != NULL)
-        free(cmd);
+        hi_free(cmd);
 
     return error_type;
 }
@@ -545,7 +602,7 @@ int redisFormatCommandArgv(char **target, int argc, const char **argv, const siz
     }
 
     /* Build the command at protocol level */
-    cmd = malloc(totlen+1);
+    cmd = hi_malloc(totlen+1);
     if (cmd == NULL)
         return -1;
 
@@ -566,7 +623,7 @@ int redisFormatCommandArgv(char **target, int argc, const char **argv, const siz
 }
 
 void redisFreeCommand(char *cmd) {
-    free(cmd);
+    hi_free(cmd);
 }
 
 void __redisSetError(redisContext *c, int type, const char *str) {
@@ -592,7 +649,7 @@ redisReader *redisReaderCreate(void) {
 static redisContext *redisContextInit(void) {
     redisContext *c;
 
-    c = calloc(1,sizeof(redisContext));
+    c = hi_calloc(1,sizeof(redisContext));
     if (c == NULL)
         return NULL;
 
@@ -623,14 +680,14 @@ void redisFree(redisContext *c) {
     if (c->reader != NULL)
         redisReaderFree(c->reader);
     if (c->tcp.host)
-        free(c->tcp.host);
+        hi_free(c->tcp.host);
     if (c->tcp.source_addr)
-        free(c->tcp.source_addr);
+        hi_free(c->tcp.source_addr);
     if (c->unix_sock.path)
-        free(c->unix_sock.path);
+        hi_free(c->unix_sock.path);
     if (c->timeout)
-        free(c->timeout);
-    free(c);
+        hi_free(c->timeout);
+    hi_free(c);
 }
 
 int redisFreeKeepFd(redisContext *c) {
@@ -641,6 +698,8 @@ int redisFreeKeepFd(redisContext *c) {
 }
 
 int redisReconnect(redisContext *c) {
+    int rv;
+
     c->err = 0;
     memset(c->errstr, '\0', strlen(c->errstr));
 
@@ -655,17 +714,19 @@ int redisReconnect(redisContext *c) {
     c->reader = redisReaderCreate();
 
     if (c->connection_type == REDIS_CONN_TCP) {
-        return redisContextConnectBindTcp(c, c->tcp.host, c->tcp.port,
+        rv = redisContextConnectBindTcp(c, c->tcp.host, c->tcp.port,
                 c->timeout, c->tcp.source_addr);
     } else if (c->connection_type == REDIS_CONN_UNIX) {
-        return redisContextConnectUnix(c, c->unix_sock.path, c->timeout);
+        rv = redisContextConnectUnix(c, c->unix_sock.path, c->timeout);
     } else {
         /* Something bad happened here and shouldn't have. There isn't
            enough information in the context to reconnect. */
         __redisSetError(c,REDIS_ERR_OTHER,"Not enough information to reconnect");
+        rv = REDIS_ERR;
     }
 
-    return REDIS_ERR;
+    PREDIS_PROBE2(reconnect, c->fd, rv);
+    return rv;
 }
 
 /* Connect to a Redis instance. On error the field error in the returned
@@ -799,7 +860,11 @@ int redisBufferRead(redisContext *c) {
     if (c->err)
         return REDIS_ERR;
 
-    nread = read(c->fd,buf,sizeof(buf));
+    {
+        PREDIS_PROBE_START(read, start);
+        nread = read(c->fd,buf,sizeof(buf));
+        PREDIS_PROBE3(read, c->fd, nread, PREDIS_PROBE_SINCE(start));
+    }
     if (nread == -1) {
         if ((errno == EAGAIN && !(c->flags & REDIS_BLOCK)) || (errno == EINTR)) {
             /* Try again later */
@@ -811,6 +876,7 @@ int redisBufferRead(redisContext *c) {
         __redisSetError(c,REDIS_ERR_EOF,"Server closed the connection");
         return REDIS_ERR;
     } else {
+        c->nread += nread;
         if (redisReaderFeed(c->reader,buf,nread) != REDIS_OK) {
             __redisSetError(c,c->reader->err,c->reader->errstr);
             return REDIS_ERR;
@@ -836,7 +902,9 @@ int redisBufferWrite(redisContext *c, int *done) {
         return REDIS_ERR;
 
     if (sdslen(c->obuf) > 0) {
+        PREDIS_PROBE_START(write, start);
         nwritten = write(c->fd,c->obuf,sdslen(c->obuf));
+        PREDIS_PROBE3(write, c->fd, nwritten, PREDIS_PROBE_SINCE(start));
         if (nwritten == -1) {
             if ((errno == EAGAIN && !(c->flags & REDIS_BLOCK)) || (errno == EINTR)) {
                 /* Try again later */
@@ -845,9 +913,16 @@ int redisBufferWrite(redisContext *c, int *done) {
                 return REDIS_ERR;
             }
         } else if (nwritten > 0) {
+            c->nwritten += nwritten;
             if (nwritten == (signed)sdslen(c->obuf)) {
-                sdsfree(c->obuf);
-                c->obuf = sdsempty();
+                /* Keep small buffers so that the next command does not
+                 * need a fresh allocation. */
+                if (sdslen(c->obuf) + sdsavail(c->obuf) <= 16*1024) {
+                    sdsclear(c->obuf);
+                } else {
+                    sdsfree(c->obuf);
+                    c->obuf = sdsempty();
+                }
             } else {
                 sdsrange(c->obuf,nwritten,-1);
             }
@@ -864,6 +939,9 @@ int redisGetReplyFromReader(redisContext *c, void **reply) {
         __redisSetError(c,c->reader->err,c->reader->errstr);
         return REDIS_ERR;
     }
+    if (reply != NULL && *reply != NULL) {
+        PREDIS_PROBE2(reply, c->fd, *reply);
+    }
     return REDIS_OK;
 }
 
@@ -914,6 +992,7 @@ int __redisAppendCommand(redisContext *c, const char *cmd, size_t len) {
     }
 
     c->obuf = newbuf;
+    PREDIS_PROBE3(append, c->fd, cmd, len);
     return REDIS_OK;
 }
 
@@ -940,11 +1019,11 @@ int redisvAppendCommand(redisContext *c, const char *format, va_list ap) {
     }
 
     if (__redisAppendCommand(c,cmd,len) != REDIS_OK) {
-        free(cmd);
+        hi_free(cmd);
         return REDIS_ERR;
     }
 
-    free(cmd);
+    hi_free(cmd);
     return REDIS_OK;
 }
 
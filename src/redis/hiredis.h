@@ -38,6 +38,7 @@
 #include <sys/time.h> /* for struct timeval */
 #include <stdint.h> /* uintXX_t, etc */
 #include "sds.h" /* for sds */
+#include "alloc.h" /* for allocation functions */
 
 #define HIREDIS_MAJOR 0
 #define HIREDIS_MINOR 13
@@ -109,8 +110,16 @@ extern "C" {
 #endif
 
 /* This is the reply object returned by redisCommand() */
+/* Short strings are stored inline right after the reply object, and well
+ * known status/error replies point to static storage, so most string replies
+ * take a single allocation. */
+#define REDIS_REPLY_INLINE_MAX 23
+#define REDIS_REPLY_STR_INLINE 0x1
+#define REDIS_REPLY_STR_STATIC 0x2
+
 typedef struct redisReply {
     int type; /* REDIS_REPLY_* */
+    int flags; /* REDIS_REPLY_STR_*: where str is stored, never freed separately when set */
     long long integer; /* The integer when type is REDIS_REPLY_INTEGER */
     size_t len; /* Length of string */
     char *str; /* Used for both REDIS_REPLY_ERROR and REDIS_REPLY_STRING */
@@ -158,6 +167,11 @@ typedef struct redisContext {
         char *path;
     } unix_sock;
 
+    /* Bytes read from / written to the socket over the context's lifetime,
+     * including reconnects. */
+    unsigned long long nread;
+    unsigned long long nwritten;
+
 } redisContext;
 
 redisContext *redisConnect(const char *ip, int port);
@@ -51,8 +51,10 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#include "alloc.h"
 #include "net.h"
 #include "sds.h"
+#include "p_redis_probe.h"
 
 /* Defined in hiredis.c */
 void __redisSetError(redisContext *c, int type, const char *str);
@@ -286,21 +288,21 @@ static int _redisContextConnectTcp(redisContext *c, const char *addr, int port,
      **/
     if (c->tcp.host != addr) {
         if (c->tcp.host)
-            free(c->tcp.host);
+            hi_free(c->tcp.host);
 
-        c->tcp.host = strdup(addr);
+        c->tcp.host = hi_strdup(addr);
     }
 
     if (timeout) {
         if (c->timeout != timeout) {
             if (c->timeout == NULL)
-                c->timeout = malloc(sizeof(struct timeval));
+                c->timeout = hi_malloc(sizeof(struct timeval));
 
             memcpy(c->timeout, timeout, sizeof(struct timeval));
         }
     } else {
         if (c->timeout)
-            free(c->timeout);
+            hi_free(c->timeout);
         c->timeout = NULL;
     }
 
@@ -310,11 +312,11 @@ static int _redisContextConnectTcp(redisContext *c, const char *addr, int port,
     }
 
     if (source_addr == NULL) {
-        free(c->tcp.source_addr);
+        hi_free(c->tcp.source_addr);
         c->tcp.source_addr = NULL;
     } else if (c->tcp.source_addr != source_addr) {
-        free(c->tcp.source_addr);
-        c->tcp.source_addr = strdup(source_addr);
+        hi_free(c->tcp.source_addr);
+        c->tcp.source_addr = hi_strdup(source_addr);
     }
 
     snprintf(_port, 6, "%d", port);
@@ -418,16 +420,34 @@ end:
 
 int redisContextConnectTcp(redisContext *c, const char *addr, int port,
                            const struct timeval *timeout) {
-    return _redisContextConnectTcp(c, addr, port, timeout, NULL);
+    int rv;
+    PREDIS_PROBE_START(connect, start);
+    rv = _redisContextConnectTcp(c, addr, port, timeout, NULL);
+    PREDIS_PROBE5(connect, c->fd, addr, port, rv, PREDIS_PROBE_SINCE(start));
+    return rv;
 }
 
 int redisContextConnectBindTcp(redisContext *c, const char *addr, int port,
                                const struct timeval *timeout,
                                const char *source_addr) {
-    return _redisContextConnectTcp(c, addr, port, timeout, source_addr);
+    int rv;
+    PREDIS_PROBE_START(connect, start);
+    rv = _redisContextConnectTcp(c, addr, port, timeout, source_addr);
+    PREDIS_PROBE5(connect, c->fd, addr, port, rv, PREDIS_PROBE_SINCE(start));
+    return rv;
 }
 
+static int _redisContextConnectUnix(redisContext *c, const char *path, const struct timeval *timeout);
+
 int redisContextConnectUnix(redisContext *c, const char *path, const struct timeval *timeout) {
+    int rv;
+    PREDIS_PROBE_START(connect, start);
+    rv = _redisContextConnectUnix(c, path, timeout);
+    PREDIS_PROBE5(connect, c->fd, path, 0, rv, PREDIS_PROBE_SINCE(start));
+    return rv;
+}
+
+static int _redisContextConnectUnix(redisContext *c, const char *path, const struct timeval *timeout) {
     int blocking = (c->flags & REDIS_BLOCK);
     struct sockaddr_un sa;
     long timeout_msec = -1;
@@ -439,18 +459,18 @@ int redisContextConnectUnix(redisContext *c, const char *path, const struct time
 
     c->connection_type = REDIS_CONN_UNIX;
     if (c->unix_sock.path != path)
-        c->unix_sock.path = strdup(path);
+        c->unix_sock.path = hi_strdup(path);
 
     if (timeout) {
         if (c->timeout != timeout) {
             if (c->timeout == NULL)
-                c->timeout = malloc(sizeof(struct timeval));
+                c->timeout = hi_malloc(sizeof(struct timeval));
 
             memcpy(c->timeout, timeout, sizeof(struct timeval));
         }
     } else {
         if (c->timeout)
-            free(c->timeout);
+            hi_free(c->timeout);
         c->timeout = NULL;
     }
 
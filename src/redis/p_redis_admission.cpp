@@ -0,0 +1,183 @@
+/*
+ * FileName : p_redis_admission.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 28 Oct 2026 11:07:42 AM CST   Created
+*/
+
+#include "p_redis_admission.h"
+#include "p_redis_latency.h"
+
+#include <algorithm>
+
+#include <string.h>
+
+using namespace pepper;
+
+static bool is_failure(PRedisError result)
+{
+    return result == PREDIS_ERR_IO || result == PREDIS_ERR_TIMEOUT
+        || result == PREDIS_ERR_NOT_CONNECTED;
+}
+
+PRedisAdmission::PRedisAdmission(const PRedisAdmissionOptions &options)
+    : options_(options), state_(STATE_CLOSED), open_until_ms_(0),
+      probes_issued_(0), probes_ok_(0), limit_(options.initial_limit),
+      in_flight_(0), last_decrease_ms_(0)
+{
+    reset_window();
+}
+
+PRedisError PRedisAdmission::admit()
+{
+    uint64_t now_ms = predis_now_us() / 1000;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (state_ == STATE_OPEN) {
+        if (now_ms < open_until_ms_) {
+            ++stats_.rejected_open;
+            return PREDIS_ERR_CIRCUIT_OPEN;
+        }
+        state_         = STATE_HALF_OPEN;
+        probes_issued_ = 0;
+        probes_ok_     = 0;
+    }
+    if (state_ == STATE_HALF_OPEN && probes_issued_ >= options_.half_open_probes) {
+        ++stats_.rejected_open;
+        return PREDIS_ERR_CIRCUIT_OPEN;
+    }
+    if (in_flight_ >= static_cast<uint32_t>(limit_)) {
+        ++stats_.shed;
+        return PREDIS_ERR_OVERLOADED;
+    }
+
+    if (state_ == STATE_HALF_OPEN) {
+        ++probes_issued_;
+    }
+    ++in_flight_;
+    ++stats_.admitted;
+
+    return PREDIS_OK;
+}
+
+void PRedisAdmission::complete(PRedisError result, uint64_t latency_us, bool blocking)
+{
+    uint64_t now_ms = predis_now_us() / 1000;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (in_flight_ > 0) {
+        --in_flight_;
+    }
+    if (result == PREDIS_ERR_CANCELLED) {
+        if (state_ == STATE_HALF_OPEN && probes_issued_ > 0) {
+            --probes_issued_;
+        }
+        return;
+    }
+
+    bool failed = is_failure(result);
+    bool slow   = !blocking && latency_us >= options_.slow_call_ms * 1000ULL;
+
+    if (!blocking) {
+        if (failed || slow) {
+            if (now_ms >= last_decrease_ms_ + options_.slow_call_ms) {
+                limit_ = std::max(limit_ * options_.backoff_ratio, static_cast<double>(options_.min_limit));
+                last_decrease_ms_ = now_ms;
+            }
+        } else {
+            limit_ = std::min(limit_ + 1.0 / limit_, static_cast<double>(options_.max_limit));
+        }
+    }
+
+    record(failed, slow, now_ms);
+}
+
+void PRedisAdmission::record_failure(PRedisError result)
+{
+    if (!is_failure(result)) {
+        return;
+    }
+
+    uint64_t now_ms = predis_now_us() / 1000;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    record(true, false, now_ms);
+}
+
+void PRedisAdmission::record(bool failed, bool slow, uint64_t now_ms)
+{
+    if (state_ == STATE_HALF_OPEN) {
+        if (failed || slow) {
+            open(now_ms);
+        } else if (++probes_ok_ >= options_.half_open_probes) {
+            state_ = STATE_CLOSED;
+            reset_window();
+        }
+        return;
+    }
+    if (state_ == STATE_OPEN) {
+        return;
+    }
+
+    uint64_t span = std::max<uint64_t>(options_.window_ms / kBuckets, 1);
+    uint64_t start = now_ms - now_ms % span;
+    Bucket &bucket = buckets_[(now_ms / span) % kBuckets];
+    if (bucket.start_ms != start) {
+        memset(&bucket, 0, sizeof(bucket));
+        bucket.start_ms = start;
+    }
+    ++bucket.total;
+    bucket.failures += failed ? 1 : 0;
+    bucket.slow     += slow ? 1 : 0;
+
+    uint32_t total = 0;
+    uint32_t failures = 0;
+    uint32_t slows = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        if (buckets_[i].start_ms + span * kBuckets > now_ms) {
+            total    += buckets_[i].total;
+            failures += buckets_[i].failures;
+            slows    += buckets_[i].slow;
+        }
+    }
+    if (total >= options_.min_requests
+            && (failures >= options_.error_rate * total || slows >= options_.slow_rate * total)) {
+        open(now_ms);
+    }
+}
+
+void PRedisAdmission::open(uint64_t now_ms)
+{
+    state_         = STATE_OPEN;
+    open_until_ms_ = now_ms + options_.open_ms;
+    ++stats_.opened;
+    reset_window();
+}
+
+void PRedisAdmission::reset_window()
+{
+    memset(buckets_, 0, sizeof(buckets_));
+}
+
+PRedisAdmission::State PRedisAdmission::state() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+uint32_t PRedisAdmission::limit() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(limit_);
+}
+
+uint32_t PRedisAdmission::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+PRedisAdmissionStats PRedisAdmission::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
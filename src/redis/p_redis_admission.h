@@ -0,0 +1,116 @@
+/*
+ * FileName : p_redis_admission.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 28 Oct 2026 11:07:42 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_error.h"
+
+#include <mutex>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisAdmissionOptions
+    {
+        /* 熔断: 最近 window_ms 内至少 min_requests 个请求, 且失败率或慢调用率超过阈值时打开 */
+        uint32_t window_ms        = 10000;
+        uint32_t min_requests     = 20;
+        double   error_rate       = 0.5;    /* IO 错误、超时、未连接算失败 (包括发送前发现的), 服务端错误回复不算 */
+        uint32_t slow_call_ms     = 200;
+        double   slow_rate        = 0.8;
+        uint32_t open_ms          = 5000;   /* 打开多久后进入半开 */
+        uint32_t half_open_probes = 5;      /* 半开时放行的探测请求数, 都成功才关闭 */
+
+        /* 并发上限 AIMD: 成功且不慢时每个请求加 1/limit, 失败或慢调用时乘 backoff_ratio,
+         * 两次减少至少间隔 slow_call_ms, 避免同一次抖动把上限一路压到底.
+         * 阻塞命令的耗时由阻塞时间决定, 不算慢调用, 也不调整上限 */
+        uint32_t initial_limit    = 32;
+        uint32_t min_limit        = 4;
+        uint32_t max_limit        = 1024;
+        double   backoff_ratio    = 0.9;
+    };
+
+    struct PRedisAdmissionStats
+    {
+        uint64_t admitted      = 0;
+        uint64_t rejected_open = 0;     /* 熔断打开时拒绝 */
+        uint64_t shed          = 0;     /* 超过并发上限拒绝 */
+        uint64_t opened        = 0;     /* 熔断打开的次数 */
+    };
+
+    /*
+     * @brief 一个 redis 节点的熔断和并发限制, 由连到该节点的所有客户端共享
+     *
+     * 每个命令发送前 admit(), 放行的命令结束后必须 complete(); 还没有 admit()
+     * 就失败的命令 (未连接、发送前已超时) 用 record_failure() 计入失败率;
+     * 被拒绝的命令立即返回 PREDIS_ERR_CIRCUIT_OPEN 或 PREDIS_ERR_OVERLOADED,
+     * 不会在慢节点上堆积等待的协程. 线程安全.
+     */
+    class PRedisAdmission : public noncopyable
+    {
+        public:
+            enum State
+            {
+                STATE_CLOSED,
+                STATE_OPEN,
+                STATE_HALF_OPEN
+            };
+
+            explicit PRedisAdmission(const PRedisAdmissionOptions &options = PRedisAdmissionOptions());
+
+            /* return PREDIS_OK 放行  PREDIS_ERR_CIRCUIT_OPEN  PREDIS_ERR_OVERLOADED */
+            PRedisError admit();
+
+            /*
+             * @brief result 为命令的结果, 取消的命令不计入统计
+             * @param blocking 阻塞命令 (BLOCK/BLMOVE 等), 只统计失败
+             */
+            void complete(PRedisError result, uint64_t latency_us, bool blocking = false);
+
+            /* 发送前失败、没有经过 admit() 的命令; 只有算失败的结果才计入 */
+            void record_failure(PRedisError result);
+
+            State state() const;
+            uint32_t limit() const;
+            uint32_t in_flight() const;
+            PRedisAdmissionStats stats() const;
+
+        private:
+            static const int kBuckets = 10;
+
+            struct Bucket
+            {
+                uint64_t start_ms;
+                uint32_t total;
+                uint32_t failures;
+                uint32_t slow;
+            };
+
+            /* 计入熔断窗口, 半开时决定关闭还是重新打开; 调用时已持有 mutex_ */
+            void record(bool failed, bool slow, uint64_t now_ms);
+            void open(uint64_t now_ms);
+            void reset_window();
+
+            PRedisAdmissionOptions options_;
+
+            mutable std::mutex     mutex_;
+            State                  state_;
+            uint64_t               open_until_ms_;
+            uint32_t               probes_issued_;
+            uint32_t               probes_ok_;
+            Bucket                 buckets_[kBuckets];
+
+            double                 limit_;
+            uint32_t               in_flight_;
+            uint64_t               last_decrease_ms_;
+
+            PRedisAdmissionStats   stats_;
+    };
+
+}
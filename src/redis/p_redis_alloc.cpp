@@ -0,0 +1,244 @@
+/*
+ * FileName : p_redis_alloc.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 09 Nov 2026 03:05:42 PM CST   Created
+*/
+
+#include "p_redis_alloc.h"
+#include "p_redis_metrics.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <string.h>
+
+using namespace pepper;
+
+namespace
+{
+
+    struct Entry
+    {
+        const char           *command;
+        std::atomic<uint64_t> allocs {0};
+        std::atomic<uint64_t> bytes  {0};
+        std::atomic<uint64_t> frees  {0};
+    };
+
+    struct ThreadTable
+    {
+        ThreadTable();
+        ~ThreadTable();
+
+        Entry *get(const char *cmd);
+
+        std::mutex                           mutex;     /* 新增条目与 collect 互斥 */
+        std::vector< std::unique_ptr<Entry> > entries;
+        Entry                                *last = nullptr;
+    };
+
+    struct Registry
+    {
+        std::mutex                        mutex;
+        std::vector<ThreadTable *>        tables;
+        std::vector<PRedisAllocCounters>  retired;
+    };
+
+    /* 不析构, 其他静态对象析构时仍可能释放 hiredis 的内存 */
+    Registry &registry()
+    {
+        static Registry *r = new Registry();
+        return *r;
+    }
+
+    enum { TABLE_NONE = 0, TABLE_ALIVE, TABLE_DESTROYED };
+
+    thread_local const char *t_command = nullptr;
+    thread_local int         t_state   = TABLE_NONE;
+    thread_local ThreadTable t_table;
+
+    hiredisAllocFuncs        s_prev;
+    std::atomic<bool>        s_installed(false);
+
+    void merge(std::vector<PRedisAllocCounters> &out, const char *cmd,
+               uint64_t allocs, uint64_t bytes, uint64_t frees)
+    {
+        for (auto &c : out) {
+            if (c.command == cmd || 0 == strcmp(c.command, cmd)) {
+                c.allocs += allocs;
+                c.bytes  += bytes;
+                c.frees  += frees;
+                return;
+            }
+        }
+        PRedisAllocCounters c = { cmd, allocs, bytes, frees };
+        out.push_back(c);
+    }
+
+    ThreadTable::ThreadTable()
+    {
+        t_state = TABLE_ALIVE;
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.tables.push_back(this);
+    }
+
+    ThreadTable::~ThreadTable()
+    {
+        t_state = TABLE_DESTROYED;
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t i = 0; i < r.tables.size(); ++i) {
+            if (r.tables[i] == this) {
+                r.tables[i] = r.tables.back();
+                r.tables.pop_back();
+                break;
+            }
+        }
+        for (auto &e : entries) {
+            merge(r.retired, e->command, e->allocs.load(), e->bytes.load(), e->frees.load());
+        }
+    }
+
+    Entry *ThreadTable::get(const char *cmd)
+    {
+        if (last != nullptr && last->command == cmd) {
+            return last;
+        }
+        for (auto &e : entries) {
+            if (e->command == cmd || 0 == strcmp(e->command, cmd)) {
+                last = e.get();
+                return last;
+            }
+        }
+
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->command = cmd;
+        last = entry.get();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back(std::move(entry));
+        return last;
+    }
+
+    /* 线程退出时 thread_local 析构之后的分配不计数 */
+    Entry *current()
+    {
+        if (t_state == TABLE_DESTROYED) {
+            return nullptr;
+        }
+
+        return t_table.get(t_command != nullptr ? t_command : "(none)");
+    }
+
+    void count_alloc(size_t bytes)
+    {
+        Entry *e = current();
+        if (e != nullptr) {
+            predis_metric_add(e->allocs, 1);
+            predis_metric_add(e->bytes, bytes);
+        }
+    }
+
+    void *counting_malloc(size_t size)
+    {
+        count_alloc(size);
+        return s_prev.mallocFn(size);
+    }
+
+    void *counting_calloc(size_t nmemb, size_t size)
+    {
+        count_alloc(nmemb * size);
+        return s_prev.callocFn(nmemb, size);
+    }
+
+    void *counting_realloc(void *ptr, size_t size)
+    {
+        count_alloc(size);
+        return s_prev.reallocFn(ptr, size);
+    }
+
+    char *counting_strdup(const char *str)
+    {
+        count_alloc(strlen(str) + 1);
+        return s_prev.strdupFn(str);
+    }
+
+    void counting_free(void *ptr)
+    {
+        if (ptr != nullptr) {
+            Entry *e = current();
+            if (e != nullptr) {
+                predis_metric_add(e->frees, 1);
+            }
+        }
+        s_prev.freeFn(ptr);
+    }
+
+}
+
+void PRedisAllocTracker::install()
+{
+    if (s_installed.exchange(true)) {
+        return;
+    }
+
+    hiredisAllocFuncs counting = {
+        counting_malloc, counting_calloc, counting_realloc, counting_strdup, counting_free
+    };
+    s_prev = hiredisSetAllocators(&counting);
+}
+
+void PRedisAllocTracker::uninstall()
+{
+    if (!s_installed.exchange(false)) {
+        return;
+    }
+
+    hiredisSetAllocators(&s_prev);
+}
+
+bool PRedisAllocTracker::installed()
+{
+    return s_installed.load(std::memory_order_relaxed);
+}
+
+const char *PRedisAllocTracker::set_command(const char *cmd)
+{
+    const char *saved = t_command;
+    t_command = cmd;
+
+    return saved;
+}
+
+void PRedisAllocTracker::collect(std::vector<PRedisAllocCounters> &out)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto &c : r.retired) {
+        merge(out, c.command, c.allocs, c.bytes, c.frees);
+    }
+    for (ThreadTable *table : r.tables) {
+        std::lock_guard<std::mutex> table_lock(table->mutex);
+        for (auto &e : table->entries) {
+            merge(out, e->command, predis_metric_load(e->allocs), predis_metric_load(e->bytes),
+                  predis_metric_load(e->frees));
+        }
+    }
+}
+
+void PRedisAllocTracker::reset()
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retired.clear();
+    for (ThreadTable *table : r.tables) {
+        std::lock_guard<std::mutex> table_lock(table->mutex);
+        for (auto &e : table->entries) {
+            e->allocs.store(0, std::memory_order_relaxed);
+            e->bytes.store(0, std::memory_order_relaxed);
+            e->frees.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * FileName : p_redis_alloc.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 09 Nov 2026 03:05:42 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "alloc.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisAllocCounters
+    {
+        const char *command;            /* 命令之外的分配 (连接、建 context 等) 为 "(none)" */
+        uint64_t    allocs;             /* malloc/calloc/realloc/strdup 次数 */
+        uint64_t    bytes;              /* 申请的字节数, realloc 按新长度计 */
+        uint64_t    frees;
+    };
+
+    /*
+     * @brief 统计经过 hiredis 分配接口 (alloc.h) 的内存分配, 按当前命令归类.
+     *
+     * install() 用计数函数包装当前的分配器, 计数函数只累加再转调原分配器,
+     * 不改变内存布局, 所以可以在任何时候安装和卸载.
+     * 计数按线程单独保存, 只有所属线程写入, collect() 汇总所有线程及已退出的线程.
+     * 当前命令由 PRedisAllocScope 设置, PRedisClient 执行命令时自动设置;
+     * 释放计入释放时的命令, 回复通常在下一条命令开始时回收.
+     */
+    class PRedisAllocTracker
+    {
+        public:
+            static void install();
+            static void uninstall();
+            static bool installed();
+
+            /* cmd 需要是字符串常量, 返回之前的命令 */
+            static const char *set_command(const char *cmd);
+
+            static void collect(std::vector<PRedisAllocCounters> &out);
+
+            /* 清零所有线程的计数, 与正在进行的分配并发时个别计数可能保留 */
+            static void reset();
+    };
+
+    class PRedisAllocScope : public noncopyable
+    {
+        public:
+            explicit PRedisAllocScope(const char *cmd) : saved_(PRedisAllocTracker::set_command(cmd)) {}
+            ~PRedisAllocScope() { PRedisAllocTracker::set_command(saved_); }
+
+        private:
+            const char *saved_;
+    };
+
+}
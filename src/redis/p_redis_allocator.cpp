@@ -0,0 +1,468 @@
+/*
+ * FileName : p_redis_allocator.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 10 Nov 2026 02:26:51 PM CST   Created
+*/
+
+#include "p_redis_allocator.h"
+
+#include <atomic>
+#include <mutex>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(PREDIS_WITH_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#endif
+
+#if defined(PREDIS_WITH_MIMALLOC)
+#include <mimalloc.h>
+#endif
+
+using namespace pepper;
+
+namespace
+{
+
+    /* 每个 size class 的可用字节数, 块大小另加 16 字节头 */
+    const uint32_t s_class_sizes[] = {
+        16, 32, 48, 64, 80, 96, 112, 128,
+        160, 192, 224, 256, 320, 384, 448, 512,
+        640, 768, 896, 1024
+    };
+
+    const int      s_classes     = sizeof(s_class_sizes) / sizeof(s_class_sizes[0]);
+    const uint32_t s_max_small   = 1024;
+    const uint32_t s_large       = 0xFFFFFFFF;
+    const size_t   s_header      = 16;
+    const size_t   s_chunk_size  = 64 * 1024;
+    const uint32_t s_batch       = 32;              /* 与仓库之间每次转移的块数 */
+    const uint32_t s_cache_limit = 4 * s_batch;     /* 线程缓存每个 class 的上限 */
+
+    struct Header
+    {
+        uint32_t cls;
+        uint32_t reserved;
+        uint64_t size;                  /* 大块的请求长度 */
+    };
+
+    struct Block
+    {
+        Block *next;
+    };
+
+    /*
+     * 128 字节以内每 16 字节一档, 之后每个 2 的幂区间分 4 档;
+     * 不用查表, 其他静态对象初始化时分配也不依赖初始化顺序
+     */
+    inline int size_class(size_t size)
+    {
+        if (size <= 128) {
+            return size > 0 ? static_cast<int>((size + 15) / 16) - 1 : 0;
+        }
+        int msb = 63 - __builtin_clzll(size - 1);
+        return 8 + (msb - 7) * 4 + static_cast<int>((size - 1) >> (msb - 2)) - 4;
+    }
+
+    struct Depot
+    {
+        std::mutex mutex;
+        Block     *head  = nullptr;
+        uint32_t   count = 0;
+    };
+
+    Depot                 s_depots[s_classes];
+    std::atomic<uint64_t> s_chunks(0);
+    std::atomic<uint64_t> s_large_allocs(0);
+    std::atomic<uint64_t> s_transfers(0);
+
+    Block *pop_list(Block *&head, uint32_t n)
+    {
+        Block *first = head;
+        Block *last  = head;
+        for (uint32_t i = 1; i < n; ++i) {
+            last = last->next;
+        }
+        head = last->next;
+        last->next = nullptr;
+
+        return first;
+    }
+
+    /* 切分一个 slab 块, 返回链表和块数 */
+    Block *carve(int cls, uint32_t &n)
+    {
+        char *chunk = static_cast<char *>(malloc(s_chunk_size));
+        if (nullptr == chunk) {
+            n = 0;
+            return nullptr;
+        }
+        s_chunks.fetch_add(1, std::memory_order_relaxed);
+
+        size_t block = s_header + s_class_sizes[cls];
+        n = static_cast<uint32_t>(s_chunk_size / block);
+        Block *head = nullptr;
+        for (uint32_t i = n; i > 0; --i) {
+            Block *b = reinterpret_cast<Block *>(chunk + (i - 1) * block);
+            b->next = head;
+            head = b;
+        }
+
+        return head;
+    }
+
+    void depot_push(int cls, Block *head, uint32_t n)
+    {
+        Block *tail = head;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+
+        Depot &d = s_depots[cls];
+        std::lock_guard<std::mutex> lock(d.mutex);
+        tail->next = d.head;
+        d.head     = head;
+        d.count   += n;
+        s_transfers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Block *depot_pop(int cls, uint32_t &n)
+    {
+        Depot &d = s_depots[cls];
+        {
+            std::lock_guard<std::mutex> lock(d.mutex);
+            if (d.count > 0) {
+                n = d.count < s_batch ? d.count : s_batch;
+                d.count -= n;
+                s_transfers.fetch_add(1, std::memory_order_relaxed);
+                return pop_list(d.head, n);
+            }
+        }
+
+        /* 新切分的块只留一批给当前线程, 其余放进仓库 */
+        Block *head = carve(cls, n);
+        if (n > s_batch) {
+            Block *rest = head;
+            for (uint32_t i = 1; i < s_batch; ++i) {
+                rest = rest->next;
+            }
+            Block *tail = rest;
+            rest = rest->next;
+            tail->next = nullptr;
+            depot_push(cls, rest, n - s_batch);
+            n = s_batch;
+        }
+
+        return head;
+    }
+
+    struct ThreadCache
+    {
+        ThreadCache();
+        ~ThreadCache();
+
+        Block   *head[s_classes];
+        uint32_t count[s_classes];
+    };
+
+    enum { CACHE_NONE = 0, CACHE_ALIVE, CACHE_DESTROYED };
+
+    thread_local int         t_state = CACHE_NONE;
+    thread_local ThreadCache t_cache;
+
+    ThreadCache::ThreadCache()
+    {
+        for (int i = 0; i < s_classes; ++i) {
+            head[i]  = nullptr;
+            count[i] = 0;
+        }
+        t_state = CACHE_ALIVE;
+    }
+
+    /* 线程退出时缓存全部还给仓库 */
+    ThreadCache::~ThreadCache()
+    {
+        t_state = CACHE_DESTROYED;
+        for (int i = 0; i < s_classes; ++i) {
+            if (head[i] != nullptr) {
+                depot_push(i, head[i], count[i]);
+                head[i] = nullptr;
+            }
+        }
+    }
+
+    void *small_alloc(int cls)
+    {
+        Block *b = nullptr;
+        if (t_state != CACHE_DESTROYED) {
+            ThreadCache &c = t_cache;
+            if (nullptr == c.head[cls]) {
+                uint32_t n = 0;
+                c.head[cls]  = depot_pop(cls, n);
+                c.count[cls] = n;
+                if (nullptr == c.head[cls]) {
+                    return nullptr;
+                }
+            }
+            b = c.head[cls];
+            c.head[cls] = b->next;
+            --c.count[cls];
+        } else {
+            uint32_t n = 1;
+            Block *batch = depot_pop(cls, n);
+            if (nullptr == batch) {
+                return nullptr;
+            }
+            b = batch;
+            if (batch->next != nullptr) {
+                depot_push(cls, batch->next, n - 1);
+            }
+        }
+
+        Header *h = reinterpret_cast<Header *>(b);
+        h->cls = static_cast<uint32_t>(cls);
+        return reinterpret_cast<char *>(h) + s_header;
+    }
+
+    void small_free(Header *h)
+    {
+        int cls = static_cast<int>(h->cls);
+        Block *b = reinterpret_cast<Block *>(h);
+
+        if (t_state == CACHE_DESTROYED) {
+            b->next = nullptr;
+            depot_push(cls, b, 1);
+            return;
+        }
+
+        ThreadCache &c = t_cache;
+        b->next = c.head[cls];
+        c.head[cls] = b;
+        if (++c.count[cls] > s_cache_limit) {
+            depot_push(cls, pop_list(c.head[cls], s_batch * 2), s_batch * 2);
+            c.count[cls] -= s_batch * 2;
+        }
+    }
+
+    inline Header *header_of(void *ptr)
+    {
+        return reinterpret_cast<Header *>(static_cast<char *>(ptr) - s_header);
+    }
+
+    inline size_t usable_size(const Header *h)
+    {
+        return h->cls == s_large ? h->size : s_class_sizes[h->cls];
+    }
+
+    void *slab_malloc(size_t size)
+    {
+        if (size <= s_max_small) {
+            return small_alloc(size_class(size));
+        }
+
+        s_large_allocs.fetch_add(1, std::memory_order_relaxed);
+        Header *h = static_cast<Header *>(malloc(s_header + size));
+        if (nullptr == h) {
+            return nullptr;
+        }
+        h->cls  = s_large;
+        h->size = size;
+        return reinterpret_cast<char *>(h) + s_header;
+    }
+
+    void slab_free(void *ptr)
+    {
+        if (nullptr == ptr) {
+            return;
+        }
+
+        Header *h = header_of(ptr);
+        if (h->cls == s_large) {
+            free(h);
+            return;
+        }
+        small_free(h);
+    }
+
+    void *slab_calloc(size_t nmemb, size_t size)
+    {
+        size_t total = nmemb * size;
+        void *p = slab_malloc(total);
+        if (p != nullptr) {
+            memset(p, 0, total);
+        }
+
+        return p;
+    }
+
+    void *slab_realloc(void *ptr, size_t size)
+    {
+        if (nullptr == ptr) {
+            return slab_malloc(size);
+        }
+
+        Header *h = header_of(ptr);
+        size_t old_size = usable_size(h);
+        if (h->cls != s_large && size <= old_size) {
+            return ptr;
+        }
+        if (h->cls == s_large && size > s_max_small) {
+            Header *nh = static_cast<Header *>(realloc(h, s_header + size));
+            if (nullptr == nh) {
+                return nullptr;
+            }
+            nh->size = size;
+            return reinterpret_cast<char *>(nh) + s_header;
+        }
+
+        void *p = slab_malloc(size);
+        if (nullptr == p) {
+            return nullptr;
+        }
+        memcpy(p, ptr, old_size < size ? old_size : size);
+        slab_free(ptr);
+
+        return p;
+    }
+
+    char *slab_strdup(const char *str)
+    {
+        size_t len = strlen(str) + 1;
+        char *p = static_cast<char *>(slab_malloc(len));
+        if (p != nullptr) {
+            memcpy(p, str, len);
+        }
+
+        return p;
+    }
+
+    size_t slab_good_size(size_t size)
+    {
+        return PRedisSlabAllocator::good_size(size);
+    }
+
+}
+
+hiredisAllocFuncs PRedisSlabAllocator::functions()
+{
+    hiredisAllocFuncs fns = { slab_malloc, slab_calloc, slab_realloc, slab_strdup, slab_free };
+    return fns;
+}
+
+hiredisAllocFuncs PRedisSlabAllocator::install()
+{
+    hiredisAllocFuncs fns = functions();
+    hiredisSetGoodSize(slab_good_size);
+
+    return hiredisSetAllocators(&fns);
+}
+
+size_t PRedisSlabAllocator::good_size(size_t size)
+{
+    return size <= s_max_small ? s_class_sizes[size_class(size)] : size;
+}
+
+void PRedisSlabAllocator::stats(PRedisSlabStats &out)
+{
+    out.chunks          = s_chunks.load(std::memory_order_relaxed);
+    out.chunk_bytes     = out.chunks * s_chunk_size;
+    out.large_allocs    = s_large_allocs.load(std::memory_order_relaxed);
+    out.depot_transfers = s_transfers.load(std::memory_order_relaxed);
+}
+
+#if defined(PREDIS_WITH_JEMALLOC)
+
+static void *je_hi_malloc(size_t size)
+{
+    return mallocx(size > 0 ? size : 1, 0);
+}
+
+static void *je_hi_calloc(size_t nmemb, size_t size)
+{
+    size_t total = nmemb * size;
+    return mallocx(total > 0 ? total : 1, MALLOCX_ZERO);
+}
+
+static void *je_hi_realloc(void *ptr, size_t size)
+{
+    if (nullptr == ptr) {
+        return je_hi_malloc(size);
+    }
+    return rallocx(ptr, size > 0 ? size : 1, 0);
+}
+
+static char *je_hi_strdup(const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char *p = static_cast<char *>(mallocx(len, 0));
+    if (p != nullptr) {
+        memcpy(p, str, len);
+    }
+    return p;
+}
+
+static void je_hi_free(void *ptr)
+{
+    if (ptr != nullptr) {
+        dallocx(ptr, 0);
+    }
+}
+
+static size_t je_hi_good_size(size_t size)
+{
+    size_t n = nallocx(size > 0 ? size : 1, 0);
+    return n > 0 ? n : size;
+}
+
+hiredisAllocFuncs pepper::predis_jemalloc_install()
+{
+    hiredisAllocFuncs fns = { je_hi_malloc, je_hi_calloc, je_hi_realloc, je_hi_strdup, je_hi_free };
+    hiredisSetGoodSize(je_hi_good_size);
+
+    return hiredisSetAllocators(&fns);
+}
+
+#endif
+
+#if defined(PREDIS_WITH_MIMALLOC)
+
+static void *mi_hi_malloc(size_t size)
+{
+    return mi_malloc(size);
+}
+
+static void *mi_hi_calloc(size_t nmemb, size_t size)
+{
+    return mi_calloc(nmemb, size);
+}
+
+static void *mi_hi_realloc(void *ptr, size_t size)
+{
+    return mi_realloc(ptr, size);
+}
+
+static char *mi_hi_strdup(const char *str)
+{
+    return mi_strdup(str);
+}
+
+static void mi_hi_free(void *ptr)
+{
+    mi_free(ptr);
+}
+
+static size_t mi_hi_good_size(size_t size)
+{
+    return mi_good_size(size);
+}
+
+hiredisAllocFuncs pepper::predis_mimalloc_install()
+{
+    hiredisAllocFuncs fns = { mi_hi_malloc, mi_hi_calloc, mi_hi_realloc, mi_hi_strdup, mi_hi_free };
+    hiredisSetGoodSize(mi_hi_good_size);
+
+    return hiredisSetAllocators(&fns);
+}
+
+#endif
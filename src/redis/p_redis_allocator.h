@@ -0,0 +1,59 @@
+/*
+ * FileName : p_redis_allocator.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 10 Nov 2026 02:26:51 PM CST   Created
+*/
+
+#pragma once
+
+#include "alloc.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisSlabStats
+    {
+        uint64_t chunks;                /* 从 libc 申请的 slab 块数 */
+        uint64_t chunk_bytes;
+        uint64_t large_allocs;          /* 超过最大 size class, 直接走 libc 的分配次数 */
+        uint64_t depot_transfers;       /* 线程缓存与全局仓库之间的批量转移次数 */
+    };
+
+    /*
+     * @brief hiredis 分配接口的 size-class slab 后端.
+     *
+     * 不超过 1024 字节的请求按 size class 从线程缓存分配, 缓存空了从全局仓库
+     * 批量取, 仓库也空了从 64KB 的 slab 块切分; 释放放回当前线程的缓存,
+     * 超过上限时批量还给仓库. 只有批量转移时加锁, 多线程使用 redis 时
+     * 不再争用 libc 的 malloc. slab 块不归还系统.
+     * 每块前有 16 字节的头记录 size class, 所以必须在创建任何 context
+     * 之前 install, 否则会释放到 libc 分配的内存.
+     */
+    class PRedisSlabAllocator
+    {
+        public:
+            /* 设置分配接口和 size class 取整, return 之前的分配接口 */
+            static hiredisAllocFuncs install();
+
+            static hiredisAllocFuncs functions();
+
+            /* size 所在 size class 的大小, 大块原样返回 */
+            static size_t good_size(size_t size);
+
+            static void stats(PRedisSlabStats &out);
+    };
+
+#if defined(PREDIS_WITH_JEMALLOC)
+    /* jemalloc 的 mallocx/rallocx/dallocx, size class 取整用 nallocx */
+    hiredisAllocFuncs predis_jemalloc_install();
+#endif
+
+#if defined(PREDIS_WITH_MIMALLOC)
+    /* mimalloc 的 mi_* 接口, size class 取整用 mi_good_size */
+    hiredisAllocFuncs predis_mimalloc_install();
+#endif
+
+}
@@ -0,0 +1,310 @@
+/*
+ * FileName : p_redis_bulk_loader.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 10:41:52 AM CST   Created
+*/
+
+#include "p_redis_bulk_loader.h"
+#include "p_redis_pipeline.h"
+
+#include <libpc/pc_logger.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace pepper;
+
+static double monotonic_sec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static uint32_t read_le32(const char *p)
+{
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+
+    return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8)
+         | (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+void PRedisBulkLoadReport::print(FILE *fp) const
+{
+    double secs = elapsed_sec > 0 ? elapsed_sec : 1e-9;
+
+    fprintf(fp, "records: %llu, replies: %llu, errors: %llu, bad records: %llu\n",
+            static_cast<unsigned long long>(records), static_cast<unsigned long long>(replies),
+            static_cast<unsigned long long>(errors), static_cast<unsigned long long>(bad_records));
+    fprintf(fp, "sent: %.2f MB in %.3f s, %.0f ops/s, %.2f MB/s\n",
+            static_cast<double>(bytes_sent) / (1024 * 1024), elapsed_sec,
+            static_cast<double>(replies) / secs,
+            static_cast<double>(bytes_sent) / (1024 * 1024) / secs);
+    for (const auto &sample : error_samples) {
+        fprintf(fp, "  %s\n", sample.c_str());
+    }
+}
+
+PRedisBulkLoader::PRedisBulkLoader(const std::string &host, int port,
+                                   const PRedisBulkLoadOptions &options)
+    : connection_(host, port), options_(options), cursor_(nullptr), end_(nullptr),
+      parsed_(0), truncated_(false)
+{
+    if (options_.window == 0) {
+        options_.window = 1;
+    }
+}
+
+PRedisBulkLoader::~PRedisBulkLoader()
+{
+}
+
+int PRedisBulkLoader::connect(uint32_t timeout_ms)
+{
+    return connection_.connect(timeout_ms);
+}
+
+void PRedisBulkLoader::set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint)
+{
+    connection_.set_endpoint(endpoint);
+}
+
+int PRedisBulkLoader::load_file(const std::string &path, PRedisBulkLoadReport &report)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        pc_log_error("bulk load open %s error: %s", path.c_str(), strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        pc_log_error("bulk load stat %s error: %s", path.c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return load_buffer(nullptr, 0, report);
+    }
+
+    size_t len = static_cast<size_t>(st.st_size);
+    void *data = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        pc_log_error("bulk load mmap %s error: %s", path.c_str(), strerror(errno));
+        return -1;
+    }
+    madvise(data, len, MADV_SEQUENTIAL);
+
+    int ret = load_buffer(static_cast<const char *>(data), len, report);
+    munmap(data, len);
+
+    return ret;
+}
+
+int PRedisBulkLoader::load_buffer(const char *data, size_t len, PRedisBulkLoadReport &report)
+{
+    double start = monotonic_sec();
+    cursor_    = data;
+    end_       = data + len;
+    parsed_    = 0;
+    truncated_ = false;
+
+    PRedisPipelineOptions pipeline_options;
+    pipeline_options.max_inflight_commands = options_.window;
+    pipeline_options.max_inflight_bytes    = options_.window_bytes;
+    pipeline_options.chunk_bytes           = options_.chunk_bytes;
+
+    uint64_t base = report.replies;
+    PRedisPipelineStats stats;
+    PRedisPipeline pipeline(connection_, pipeline_options);
+    int ret = pipeline.run(
+            [this, &report](PRespWriter &writer) {
+                return next_record(writer, report);
+            },
+            [this, &report, base](uint64_t seq, const redisReply *reply) {
+                if (reply->type == REDIS_REPLY_ERROR
+                        && report.error_samples.size() < options_.max_error_samples) {
+                    report.error_samples.push_back("record #" + std::to_string(base + seq + 1)
+                                                   + ": " + std::string(reply->str, reply->len));
+                }
+            },
+            &stats);
+
+    report.records     += stats.commands;
+    report.replies     += stats.replies;
+    report.errors      += stats.errors;
+    report.bytes_sent  += stats.bytes_sent;
+    report.elapsed_sec += monotonic_sec() - start;
+    if (ret != 0) {
+        pc_log_error("bulk load error: connection failed after %llu replies",
+                     static_cast<unsigned long long>(report.replies));
+    } else if (truncated_) {
+        ret = -1;
+    }
+
+    return ret;
+}
+
+/*
+ * 解析下一条记录并编码, 跳过空行; 输入结束或记录不完整时返回 false,
+ * 不完整的记录之后的内容无法定位, 不再继续
+ */
+bool PRedisBulkLoader::next_record(PRespWriter &writer, PRedisBulkLoadReport &report)
+{
+    while (cursor_ < end_) {
+        fields_.clear();
+        switch (options_.format) {
+        case PRedisBulkLoadOptions::FORMAT_CSV:
+            cursor_ = next_csv(cursor_, end_);
+            break;
+        case PRedisBulkLoadOptions::FORMAT_BINARY:
+            cursor_ = next_binary(cursor_, end_);
+            break;
+        default:
+            cursor_ = next_tsv(cursor_, end_);
+            break;
+        }
+        if (nullptr == cursor_) {
+            ++report.bad_records;
+            truncated_ = true;
+            cursor_    = end_;
+            pc_log_error("bulk load error: truncated record after #%llu",
+                         static_cast<unsigned long long>(report.records + parsed_));
+            return false;
+        }
+        if (fields_.empty()) {
+            continue;
+        }
+
+        size_t argc = fields_.size() + (options_.command.empty() ? 0 : 1);
+        writer.begin(argc);
+        if (!options_.command.empty()) {
+            writer.arg(options_.command);
+        }
+        for (const auto &field : fields_) {
+            writer.arg(field.data, field.len);
+        }
+        ++parsed_;
+        return true;
+    }
+
+    return false;
+}
+
+const char *PRedisBulkLoader::next_tsv(const char *p, const char *end)
+{
+    const char *eol = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char *next = eol ? eol + 1 : end;
+    const char *line_end = eol ? eol : end;
+    if (line_end > p && line_end[-1] == '\r') {
+        --line_end;
+    }
+    if (line_end == p) {
+        return next;
+    }
+
+    const char *field = p;
+    for (;;) {
+        const char *tab = static_cast<const char *>(
+                memchr(field, '\t', static_cast<size_t>(line_end - field)));
+        const char *field_end = tab ? tab : line_end;
+        Field f = { field, static_cast<size_t>(field_end - field) };
+        fields_.push_back(f);
+        if (nullptr == tab) {
+            break;
+        }
+        field = tab + 1;
+    }
+
+    return next;
+}
+
+/*
+ * 带引号的字段需要去掉转义, 内容先写到 scratch_, 整条记录解析完后再取指针
+ */
+const char *PRedisBulkLoader::next_csv(const char *p, const char *end)
+{
+    scratch_.clear();
+    scratch_offsets_.clear();
+
+    bool line_empty = true;
+    for (;;) {
+        size_t start = scratch_.size();
+        if (p < end && *p == '"') {
+            ++p;
+            for (;;) {
+                const char *quote = static_cast<const char *>(
+                        memchr(p, '"', static_cast<size_t>(end - p)));
+                if (nullptr == quote) {
+                    /* 引号没有闭合, 记录不完整 */
+                    return nullptr;
+                }
+                scratch_.append(p, static_cast<size_t>(quote - p));
+                p = quote + 1;
+                if (p < end && *p == '"') {
+                    scratch_.push_back('"');
+                    ++p;
+                    continue;
+                }
+                break;
+            }
+            line_empty = false;
+        }
+        while (p < end && *p != ',' && *p != '\n') {
+            if (*p != '\r' || (p + 1 < end && p[1] != '\n')) {
+                scratch_.push_back(*p);
+                line_empty = false;
+            }
+            ++p;
+        }
+        scratch_offsets_.push_back(start);
+        scratch_offsets_.push_back(scratch_.size() - start);
+
+        if (p < end && *p == ',') {
+            ++p;
+            line_empty = false;
+            continue;
+        }
+        if (p < end) {
+            ++p;
+        }
+        break;
+    }
+
+    if (line_empty) {
+        return p;
+    }
+    for (size_t i = 0; i < scratch_offsets_.size(); i += 2) {
+        Field f = { scratch_.data() + scratch_offsets_[i], scratch_offsets_[i+1] };
+        fields_.push_back(f);
+    }
+
+    return p;
+}
+
+const char *PRedisBulkLoader::next_binary(const char *p, const char *end)
+{
+    for (int i = 0; i < 2; ++i) {
+        if (end - p < 4) {
+            return nullptr;
+        }
+        uint32_t len = read_le32(p);
+        p += 4;
+        if (static_cast<size_t>(end - p) < len) {
+            return nullptr;
+        }
+        Field f = { p, len };
+        fields_.push_back(f);
+        p += len;
+    }
+
+    return p;
+}
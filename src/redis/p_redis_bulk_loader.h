@@ -0,0 +1,113 @@
+/*
+ * FileName : p_redis_bulk_loader.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 10:41:52 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+#include "p_redis_resp.h"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace pepper
+{
+
+    struct PRedisBulkLoadOptions
+    {
+        enum Format
+        {
+            FORMAT_TSV,         /* 每行一条记录, 字段以 \t 分隔 */
+            FORMAT_CSV,         /* RFC 4180, 支持 "" 转义及引号内换行 */
+            FORMAT_BINARY       /* [u32 klen][key][u32 vlen][value], 小端 */
+        };
+
+        Format      format       = FORMAT_TSV;
+
+        /*
+         * 每条记录前面加上的命令, 记录的字段依次作为后续参数,
+         * 例如 "SET" + (key, value), "HSET" + (key, field, value);
+         * 为空时记录的第一个字段就是命令名
+         */
+        std::string command      = "SET";
+
+        size_t      window       = 10000;       /* 最多未收到回复的命令数 */
+        size_t      window_bytes = 64 << 20;    /* 未收到回复的命令的字节数上限 */
+        size_t      chunk_bytes  = 1 << 20;     /* 积累多少字节写一次 socket */
+        size_t      max_error_samples = 10;
+    };
+
+    struct PRedisBulkLoadReport
+    {
+        uint64_t records     = 0;       /* 已发送的命令数 */
+        uint64_t replies     = 0;       /* 已收到的回复数 */
+        uint64_t errors      = 0;       /* 错误回复数 */
+        uint64_t bad_records = 0;       /* 解析失败被跳过的记录数 */
+        uint64_t bytes_sent  = 0;
+        double   elapsed_sec = 0;
+
+        /* "record #n: <错误信息>" 形式的前若干个错误 */
+        std::vector<std::string> error_samples;
+
+        void print(FILE *fp) const;
+    };
+
+    /*
+     * @brief 批量导入, 类似 redis-cli --pipe
+     *
+     * 输入文件 mmap 后逐条解析, 直接编码为 RESP 写入一个大的输出缓冲,
+     * 由 PRedisPipeline 按 chunk_bytes 整块写 socket; 未收到回复的命令
+     * 超过 window 时先读回复再继续解析, 两端内存占用都有上限.
+     */
+    class PRedisBulkLoader : public noncopyable
+    {
+        public:
+            PRedisBulkLoader(const std::string &host, int port,
+                             const PRedisBulkLoadOptions &options);
+            ~PRedisBulkLoader();
+
+            int connect(uint32_t timeout_ms);
+
+            /* 跟随 endpoint 的地址, 地址变化后在下一次 load 开始时切换 */
+            void set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /*
+             * return 0 全部发送并收到回复(可能包含错误回复, 见 report.errors)
+             *       -1 文件或连接异常, 或记录不完整(二进制记录被截断、CSV 引号没有闭合),
+             *          report 中为已完成的部分
+             */
+            int load_file(const std::string &path, PRedisBulkLoadReport &report);
+            int load_buffer(const char *data, size_t len, PRedisBulkLoadReport &report);
+
+        private:
+            struct Field
+            {
+                const char *data;
+                size_t      len;
+            };
+
+            const char *next_tsv(const char *p, const char *end);
+            const char *next_csv(const char *p, const char *end);
+            const char *next_binary(const char *p, const char *end);
+
+            bool next_record(PRespWriter &writer, PRedisBulkLoadReport &report);
+
+            PRedisConnection      connection_;
+            PRedisBulkLoadOptions options_;
+
+            const char           *cursor_;
+            const char           *end_;
+            uint64_t              parsed_;      /* 本次 load_buffer 已编码的记录数 */
+            bool                  truncated_;
+            std::vector<Field>    fields_;
+            std::vector<size_t>   scratch_offsets_;
+            std::string           scratch_;
+    };
+
+}
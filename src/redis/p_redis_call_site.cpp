@@ -0,0 +1,142 @@
+/*
+ * FileName : p_redis_call_site.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 05 Nov 2026 04:12:30 PM CST   Created
+*/
+
+#include "p_redis_call_site.h"
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace pepper;
+
+static bool same_str(const char *a, const char *b)
+{
+    return a == b || (a != nullptr && b != nullptr && 0 == strcmp(a, b));
+}
+
+uint64_t PRedisCallSiteCounters::total_us() const
+{
+    uint64_t total = 0;
+    for (auto &c : commands) {
+        total += c.total_us;
+    }
+
+    return total;
+}
+
+PRedisCallSiteCounters *PRedisCallSiteStats::enter(const PRedisCallSite &site)
+{
+    PRedisCallSiteCounters *counters = nullptr;
+    for (auto &s : sites_) {
+        if (s->site.line == site.line && same_str(s->site.file, site.file)
+                && same_str(s->site.label, site.label)) {
+            counters = s.get();
+            break;
+        }
+    }
+    if (nullptr == counters) {
+        counters = add(site);
+    }
+    ++counters->scopes;
+
+    return counters;
+}
+
+PRedisCallSiteCounters *PRedisCallSiteStats::add(const PRedisCallSite &site)
+{
+    std::unique_ptr<PRedisCallSiteCounters> counters(new PRedisCallSiteCounters());
+    counters->site   = site;
+    counters->scopes = 0;
+    sites_.push_back(std::move(counters));
+
+    return sites_.back().get();
+}
+
+void PRedisCallSiteStats::record(PRedisCallSiteCounters *site, const char *cmd, bool error,
+                                 uint64_t bytes_sent, uint64_t bytes_received, uint64_t us)
+{
+    if (nullptr == site) {
+        if (nullptr == unattributed_) {
+            PRedisCallSite none = { "(unattributed)", nullptr, 0 };
+            unattributed_ = add(none);
+        }
+        site = unattributed_;
+    }
+
+    PRedisCallSiteCommand *command = nullptr;
+    for (auto &c : site->commands) {
+        if (c.command == cmd || 0 == strcmp(c.command, cmd)) {
+            command = &c;
+            break;
+        }
+    }
+    if (nullptr == command) {
+        PRedisCallSiteCommand c = { cmd, 0, 0, 0, 0, 0, 0 };
+        site->commands.push_back(c);
+        command = &site->commands.back();
+    }
+
+    ++command->calls;
+    command->errors         += error ? 1 : 0;
+    command->bytes_sent     += bytes_sent;
+    command->bytes_received += bytes_received;
+    command->total_us       += us;
+    command->max_us          = std::max(command->max_us, us);
+}
+
+void PRedisCallSiteStats::report(std::string &out, size_t top_n) const
+{
+    std::vector<const PRedisCallSiteCounters *> sorted;
+    sorted.reserve(sites_.size());
+    for (auto &s : sites_) {
+        sorted.push_back(s.get());
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const PRedisCallSiteCounters *a, const PRedisCallSiteCounters *b) {
+                  return a->total_us() > b->total_us();
+              });
+    if (sorted.size() > top_n) {
+        sorted.resize(top_n);
+    }
+
+    char line[512];
+    snprintf(line, sizeof(line), "redis call sites by total latency (top %zu of %zu)\n",
+             sorted.size(), sites_.size());
+    out += line;
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const PRedisCallSiteCounters *s = sorted[i];
+        snprintf(line, sizeof(line), "%2zu. %s %s:%d  scopes %llu  total %.3fms\n", i + 1,
+                 s->site.label != nullptr ? s->site.label : "-",
+                 s->site.file != nullptr ? s->site.file : "-", s->site.line,
+                 static_cast<unsigned long long>(s->scopes),
+                 static_cast<double>(s->total_us()) / 1000.0);
+        out += line;
+
+        for (auto &c : s->commands) {
+            snprintf(line, sizeof(line),
+                     "      %-12s calls %llu (%.1f/scope) errors %llu sent %llu recv %llu"
+                     " avg %lluus max %lluus\n",
+                     c.command, static_cast<unsigned long long>(c.calls),
+                     s->scopes > 0 ? static_cast<double>(c.calls) / static_cast<double>(s->scopes) : 0.0,
+                     static_cast<unsigned long long>(c.errors),
+                     static_cast<unsigned long long>(c.bytes_sent),
+                     static_cast<unsigned long long>(c.bytes_received),
+                     static_cast<unsigned long long>(c.calls > 0 ? c.total_us / c.calls : 0),
+                     static_cast<unsigned long long>(c.max_us));
+            out += line;
+        }
+    }
+}
+
+void PRedisCallSiteStats::reset()
+{
+    for (auto &s : sites_) {
+        s->scopes = 0;
+        s->commands.clear();
+    }
+}
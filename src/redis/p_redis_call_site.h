@@ -0,0 +1,78 @@
+/*
+ * FileName : p_redis_call_site.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 05 Nov 2026 04:12:30 PM CST   Created
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /* label/file 需要是字符串常量, 只保存指针 */
+    struct PRedisCallSite
+    {
+        const char *label;
+        const char *file;
+        int         line;
+    };
+
+    struct PRedisCallSiteCommand
+    {
+        const char *command;
+        uint64_t    calls;
+        uint64_t    errors;
+        uint64_t    bytes_sent;
+        uint64_t    bytes_received;
+        uint64_t    total_us;
+        uint64_t    max_us;
+    };
+
+    struct PRedisCallSiteCounters
+    {
+        PRedisCallSite                     site;
+        uint64_t                           scopes;     /* 进入该调用点的次数 */
+        std::vector<PRedisCallSiteCommand> commands;
+
+        uint64_t total_us() const;
+    };
+
+    /*
+     * @brief 按调用点汇总命令次数、字节数和耗时, 由 PRedisClient::enable_call_sites 开启.
+     * 每次进入调用点执行的命令数 (calls / scopes) 大, 通常是逐条查询 (N+1),
+     * 可以改成 MGET/HMGET 或 pipeline
+     */
+    class PRedisCallSiteStats
+    {
+        public:
+            PRedisCallSiteStats() : unattributed_(nullptr) {}
+
+            /* 查找或新建调用点并计入一次进入 */
+            PRedisCallSiteCounters *enter(const PRedisCallSite &site);
+
+            /* site 为 nullptr 时计入 "(unattributed)" */
+            void record(PRedisCallSiteCounters *site, const char *cmd, bool error,
+                        uint64_t bytes_sent, uint64_t bytes_received, uint64_t us);
+
+            const std::vector< std::unique_ptr<PRedisCallSiteCounters> > &sites() const { return sites_; }
+
+            /* 按总耗时取前 top_n 个调用点, 文本报告追加到 out */
+            void report(std::string &out, size_t top_n) const;
+
+            void reset();
+
+        private:
+            PRedisCallSiteCounters *add(const PRedisCallSite &site);
+
+            std::vector< std::unique_ptr<PRedisCallSiteCounters> > sites_;
+            PRedisCallSiteCounters                                *unattributed_;
+    };
+
+}
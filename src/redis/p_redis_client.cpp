@@ -11,1253 +11,1325 @@
 #include <string>
 #include <vector>
 
+#include <errno.h>
+#include <poll.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 using namespace pepper;
 
-bool PRedisClient::bool is_init_ok()
-{
-    return redis_context_ != nullptr ? true : false;
-}
+int PRedisClient::s_ignore_ref_params = 0;
 
-int PRedisClient::set(const std::string &key, const std::string &value)
-{
-    if (!is_init_ok()) { return -1 };
+/* 迟到的回复超过这个数时不再逐个丢弃, 直接重连 */
+static const uint32_t s_max_stale_replies = 8;
 
-    reply = redisCommand(redis_context_, "SET %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SET %s %s error: reply is nullptr", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SET %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("SET %s %s error: reply type is not REDIS_REPLY_STRING",
-                     key.c_str(), value.c_str());
-    }
+static const int s_cancel_check_ms = 5;
 
-    if (0 != strcmp(reply->str, "OK")) {
-        return 0;
+PRedisClient::~PRedisClient()
+{
+    reply_.reset();
+    if (redis_context_ != nullptr) {
+        reply_pool_.detach(redis_context_);
     }
-
-    return 1;
 }
 
-int PRedisClient::setnx(const std::string &key, const std::string &value)
+int PRedisClient::enable_compression(const PRedisCompressionOptions &options)
 {
-    if (!is_init_ok()) { return -1 };
-
-    reply = redisCommand(redis_context_, "SETNX %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SETNX %s %s error: reply is nullptr", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SETNX %s %s error", key.c_str(), value.c_str());
+    std::unique_ptr<PRedisCompressor> compressor(new PRedisCompressor(options));
+    if (0 != compressor->init()) {
         return -1;
     }
+    compressor_ = std::move(compressor);
 
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SETNX %s %s error: reply type is not REDIS_REPLY_INTEGER",
-                     key.c_str(), value.c_str());
-    }
+    return 0;
+}
 
-    return static_cast<int>(reply->integer);
+const PRedisCompressionStats *PRedisClient::compression_stats() const
+{
+    return compressor_ ? &compressor_->stats() : nullptr;
 }
 
-int PRedisClient::setex(const std::string &key, uint32_t seconds,
-                        const std::string &value)
+/*
+ * 出现 IO 错误后 context 的 err 一直保留, 不能再发送命令, 必须重连
+ */
+bool PRedisClient::is_init_ok()
 {
-    if (!is_init_ok()) { return -1 };
+    return redis_context_ != nullptr && 0 == redis_context_->err;
+}
 
-    reply = redisCommand(redis_context_, "SETEX %s %u %s", key.c_str(), seconds, value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SETEX %s %u %s error: reply is nullptr", key.c_str(), seconds, value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SETEX %s %u %s error", key.c_str(), seconds, value.c_str());
-        return -1;
+int PRedisClient::health_check()
+{
+    if (nullptr == redis_context_) {
+        return 0;
     }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("SETEX %s %u %s error: reply type is not REDIS_REPLY_STRING",
-                     key.c_str(), seconds, value.c_str());
+    if (redis_context_->err || stale_replies_ > s_max_stale_replies) {
+        if (!try_reconnect() && redis_context_->err) {
+            return 0;
+        }
     }
 
-    if (0 != strcmp(reply->str, "OK")) {
-        pc_log_error("SETEX %s %u %s error: Return val is not OK", key.c_str(), seconds, value.c_str());
-        return 0;
+    if (predis_now_us() - last_used_us_ >= health_options_.ping_idle_ms * 1000ULL) {
+        PRespWriter writer = begin_command(1);
+        writer.arg("PING", 4);
+        redisReply *r = exec_command("PING", PStringRef(), REDIS_REPLY_STATUS);
+        return nullptr != r ? 1 : 0;
     }
 
     return 1;
 }
 
-long long PRedisClient::incr(const std::string &key)
+void PRedisClient::set_health_options(const PRedisHealthOptions &options)
 {
-    if (!is_init_ok()) { return -1 };
-
-    reply = redisCommand(redis_context_, "INCR %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("INCR %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("INCR %s error", key.c_str());
-        return -1;
-    }
+    health_options_ = options;
+}
 
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SETNX %s error: reply type is not REDIS_REPLY_INTEGER",
-                     key.c_str());
-        return -1;
-    }
+void PRedisClient::set_reconnect_budget(const std::shared_ptr<PRedisReconnectBudget> &budget)
+{
+    reconnect_budget_ = budget;
+}
 
-    return reply->integer;
+uint32_t PRedisClient::reconnect_failures() const
+{
+    return reconnect_schedule_.failures();
 }
 
-int PRedisClient::mset(const std::vector<std::pair<std::string, std::string> > &fields)
+void PRedisClient::set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint)
 {
-    if (!is_init_ok()) { return -1; }
+    endpoint_            = endpoint;
+    endpoint_generation_ = 0;
+}
 
-    if (fields.size() % 2 != 0 && fields.size() > 0) {
-        pc_log_error("fields is not leagel");
-        return -1;
-    }
-    
-    std::string fields_str;
-    for (auto field : fields) {
-        fields_str += field;
-        fields_str += " ";
+void PRedisClient::enable_metrics()
+{
+    if (!metrics_) {
+        metrics_.reset(new PRedisMetrics());
     }
+}
 
-    reply = redisCommand(redis_context_, "MSET %s", fields_str.c_str());
-    if (nullptr == reply) {
-        pc_log_error("MSET %s error: reply is nullptr", fields_str.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("MSET %s error", fields_str.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("MSET %s error: type is not REDIS_REPLY_STRING", fields_str.c_str());
-        return -1;
-    }
-    if (0 != strcmp(reply->str, "OK")) {
-        pc_log_error("MSET %s error: return val is not \"OK\"");
-        return -1;
+static void endpoint_name(const redisContext *c, char *name, size_t size)
+{
+    if (c->connection_type == REDIS_CONN_TCP && c->tcp.host != nullptr) {
+        snprintf(name, size, "%s:%d", c->tcp.host, c->tcp.port);
+    } else if (c->unix_sock.path != nullptr) {
+        snprintf(name, size, "%s", c->unix_sock.path);
+    } else {
+        snprintf(name, size, "unknown");
     }
-    return 0;
 }
 
-int PRedisClient::mget(const std::vector<std::string> &keys, std::vector<std::string> &values)
+PRedisMetrics::Endpoint *PRedisClient::metrics_endpoint()
 {
-    if (!is_init_ok()) { return -1; }
-
-    if (keys.size() % 2 != 0 && keys.size() > 0) {
-        pc_log_error("keys is not leagel");
-        return -1;
+    if (nullptr == metrics_endpoint_) {
+        char name[300];
+        endpoint_name(redis_context_, name, sizeof(name));
+        metrics_endpoint_ = metrics_->endpoint(name);
     }
 
-    std::string keys_str;
-    for (auto key : keys) {
-        keys_str += key;
-        keys_str += " ";
-    }
+    return metrics_endpoint_;
+}
 
-    reply = redisCommand(redis_context_, "MGET %s", keys_str.c_str());
-    if (nullptr == reply) {
-        pc_log_error("MGET %s error: reply is nullptr", keys_str.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("MGET %s error", keys_str.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("MGET %s error: type is not REDIS_REPLY_ARRAY", keys_str.c_str());
-        return -1;
-    }
-    if (reply->elements < 1) {
-        pc_log_error("MGET %s error: elements is less than 1", keys_str.c_str());
-        return 0;
+void PRedisClient::set_slowlog(const std::shared_ptr<PRedisSlowlog> &slowlog)
+{
+    slowlog_ = slowlog;
+    if (slowlog_) {
+        /* 校准要自旋约 10ms, 放在这里而不是第一条慢命令上 */
+        predis_ticks_per_ns();
     }
+}
 
-    for (int i = 0 ; i < reply->elements; i++) {
-        if (reply->element[i]->type != REDIS_REPLY_STRING) {
-            values.push_back("");
+/*
+ * cmd_buf_ 在下一条命令开始前保持不变, 参数从这里格式化
+ */
+void PRedisClient::record_slow(uint64_t elapsed_us, uint64_t received)
+{
+    PRedisSlowlogEntry entry;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ms = static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+    entry.start_ms    = now_ms - elapsed_us / 1000;
+    entry.duration_us = elapsed_us;
+    entry.fd          = redis_context_->fd;
+    entry.error       = last_error_;
+    entry.reply_bytes = received;
+
+    char name[300];
+    endpoint_name(redis_context_, name, sizeof(name));
+    entry.endpoint = name;
+
+    if (phase_timer_.timing()) {
+        double ticks_per_ns = predis_ticks_per_ns();
+        for (int i = 0; i < PREDIS_PHASE_COUNT; ++i) {
+            entry.phase_ns[i] = static_cast<uint64_t>(static_cast<double>(phase_timer_.ticks()[i]) / ticks_per_ns);
         }
-        values.push_back(reply->element[i]->str);
     }
 
-    return values.size();
+    slowlog_->add(entry, cmd_buf_.data(), cmd_buf_.size());
 }
 
-int PRedisClient::get(const std::string &key, std::string &value)
+/*
+ * 客户端同步执行命令, 走到这里时上一条命令已经结束, 旧节点上没有在途的命令;
+ * 改写 context 中的地址后 redisReconnect, context 本身不变.
+ * 切换同样消耗重连令牌, 没有令牌时留在旧连接上, 下一条命令再切换
+ */
+void PRedisClient::follow_endpoint()
 {
-    if (!is_init_ok()) { return -1; }
-    
-    reply = redisCommand(redis_context_, "GET %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("GET %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("GET %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_NIL) {
-        pc_log_info("GET %s info: (nil)", key.c_str());
-        return 0;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("Get %s error: type is not REDIS_REPLY_STRING", key.c_str());
-        return -1;
-    }
-    value = reply->str;
-
-    return 0;
+    std::string host;
+    int port = 0;
+    uint64_t generation = endpoint_->get(host, port);
+    if (host.empty() || redis_context_->connection_type != REDIS_CONN_TCP) {
+        endpoint_generation_ = generation;
+        return;
+    }
+    if (0 == redis_context_->err && redis_context_->tcp.host != nullptr
+            && host == redis_context_->tcp.host && port == redis_context_->tcp.port) {
+        endpoint_generation_ = generation;
+        return;
+    }
+    if (reconnect_budget_ && !reconnect_budget_->take()) {
+        return;
+    }
+    endpoint_generation_ = generation;
+
+    char *new_host = hi_strdup(host.c_str());
+    if (nullptr == new_host) {
+        return;
+    }
+    hi_free(redis_context_->tcp.host);
+    redis_context_->tcp.host = new_host;
+    redis_context_->tcp.port = port;
+    metrics_endpoint_ = nullptr;
+
+    reconnect();
+    if (redis_context_->err) {
+        pc_log_error("switch to %s:%d error: %s", host.c_str(), port, redis_context_->errstr);
+        reconnect_schedule_.defer(predis_now_us(), health_options_);
+        return;
+    }
+    reconnect_schedule_.succeeded();
 }
 
-int PRedisClient::del(const std::string &key)
+/*
+ * 没到重连时间或没有拿到令牌时直接返回 false, 调用方立即失败, 不会阻塞在 connect 上
+ */
+bool PRedisClient::try_reconnect()
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("DEL %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("DEL %s error: reply is nullptr", key.c_str());
-        return -1;
+    uint64_t now = predis_now_us();
+    if (!reconnect_schedule_.due(now)) {
+        return false;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("DEL %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("DEL %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
-        return -1;
+    if (reconnect_budget_ && !reconnect_budget_->take()) {
+        reconnect_schedule_.defer(now, health_options_);
+        return false;
     }
-    return reply->integer;
-}
 
-int PRedisClient::del(const std::vector<std::string> &keys)
-{
-    if (!is_init_ok()) { return -1; }
-
-    std::string keys_str;
-    for (auto key : keys) {
-        keys_str += key;
-        keys_str += " ";
+    reconnect();
+    if (redis_context_->err) {
+        if (error_log_.allow()) {
+            pc_log_error("reconnect error: %s, %u failures", redis_context_->errstr,
+                         reconnect_schedule_.failures() + 1);
+        }
+        reconnect_schedule_.defer(now, health_options_);
+        return false;
     }
+    reconnect_schedule_.succeeded();
 
-    reply = redisCommand("DEL %s", keys_str.c_str());
-    if (nullptr == reply) {
-        pc_log_error("DEL %s error: reply is nullptr", keys_str.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("DEL %s error", keys_str.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("DEL %s error: type is not REDIS_REPLY_INTEGER", keys_str.c_str());
-        return -1;
-    }
-    return reply->integer;
+    return true;
 }
 
-long int PRedisClient::dbsize()
+void PRedisClient::set_phase_sampling(uint32_t every_n)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("DBSIZE");
-    if (nullptr == reply) {
-        pc_log_error("DBSIZE error: reply is nullptr");
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("DBSIZE error");
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("DBSIZE error: type is not REDIS_REPLY_INTEGER");
-        return -1;
+    phase_timer_.set_sample_every(every_n);
+    if (every_n != 0) {
+        predis_ticks_per_ns();
     }
-    return reply->integer;
 }
 
-int PRedisClient::expire(const std::string &key, uint32_t secs)
+const std::vector<PRedisPhaseCounters> &PRedisClient::phase_counters() const
 {
-    if (!is_init_ok()) { return -1; }
+    return phase_timer_.counters();
+}
 
-    reply = redisCommand("EXPIRE %s %u", key.c_str(), secs);
-    if (nullptr == reply) {
-        pc_log_error("EXPIRE %s %u error: reply is nullptr", key.c_str(), secs);
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("EXPIRE %s %u error", key.c_str(), secs);
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("EXPIRE %s %u error: type is not REDIS_REPLY_INTEGER");
-        return -1;
+void PRedisClient::enable_call_sites()
+{
+    if (!call_sites_) {
+        call_sites_.reset(new PRedisCallSiteStats());
     }
-    return reply->integer;
 }
 
-int PRedisClient::keys(const std::string &pattern, std::vector<std::string> &out)
+const PRedisCallSiteStats *PRedisClient::call_site_stats() const
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("KEYS %s", pattern.c_str());
-    if (nullptr == reply) {
-        pc_log_error("KEYS %s error: reply is nullptr", pattern.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("KEYS %s error", pattern.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("KEYS %s error: type is not REDIS_REPLY_ARRAY", pattern.c_str());
-        return -1;
-    }
+    return call_sites_.get();
+}
 
-    for (int i = 0; i < reply->elements; i++) {
-        out.push_back(reply->element[i]->str);
+std::string PRedisClient::call_site_report(size_t top_n) const
+{
+    std::string out;
+    if (call_sites_) {
+        call_sites_->report(out, top_n);
     }
 
-    return reply->elements;
+    return out;
 }
 
-int PRedisClient::exists(const std::string &key)
+PRedisCallSiteCounters *PRedisClient::enter_call_site(const PRedisCallSite &site)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("EXISTS %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("EXISTS %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("EXISTS %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("EXISTS %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
-        return -1;
+    PRedisCallSiteCounters *saved = call_site_;
+    if (call_sites_) {
+        call_site_ = call_sites_->enter(site);
     }
 
-    return reply->integer;
+    return saved;
 }
 
-int PRedisClient::sadd(const std::string &key, const std::string &value)
+void PRedisClient::leave_call_site(PRedisCallSiteCounters *saved)
 {
-    if (!is_init_ok()) { return -1; }
+    call_site_ = saved;
+}
 
-    reply = redisCommand("SADD %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SADD %s %s error: reply is nullptr", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SADD %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SADD %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
-    }
+PRespWriter PRedisClient::begin_command(size_t argc)
+{
+    phase_timer_.start(slowlog_ != nullptr);
+    cmd_buf_.clear();
+    PRespWriter writer(cmd_buf_);
+    writer.begin(argc);
 
-    return reply->integer;
+    return writer;
 }
 
-int PRedisClient::sadd(const std::string &key, const std::vector<std::string> &values)
+PRespWriter PRedisClient::begin_command(const std::string &prefix)
 {
-    if (!is_init_ok()) { return -1; }
+    phase_timer_.start(slowlog_ != nullptr);
+    cmd_buf_.assign(prefix);
 
-    std::string value_str;
-    for (auto value : values) {
-        value_str += value;
-        value_str += " ";
-    }
+    return PRespWriter(cmd_buf_);
+}
 
-    reply = redisCommand("SADD %s %s", key.c_str(), value_str.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SADD %s %s error: reply is nullptr", key.c_str(), value_str.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SADD %s %s error", key.c_str(), value_str.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SADD %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value_str.c_str());
-        return -1;
+/*
+ * 错误只在这里计数和输出日志, 日志按 error_log_ 限流;
+ * NIL 回复只计数
+ */
+int PRedisClient::report_error(const char *cmd, PStringRef key, PRedisError error,
+                               const char *message)
+{
+    last_error_ = error;
+    last_error_message_.assign(message);
+    ++command_stats_.get(cmd).errors;
+
+    if (error_log_.allow()) {
+        uint64_t suppressed = error_log_.take_suppressed();
+        if (suppressed > 0) {
+            pc_log_error("%s %.*s error: %s (%llu similar errors suppressed)",
+                         cmd, key.isize(), key.data(), message,
+                         static_cast<unsigned long long>(suppressed));
+        } else {
+            pc_log_error("%s %.*s error: %s", cmd, key.isize(), key.data(), message);
+        }
     }
 
-    return reply->integer;
+    return -1;
 }
 
-int PRedisClient::srem(const std::string &key, const std::string &value)
+void PRedisClient::fail_before_send(const char *cmd, PStringRef key, PRedisError error,
+                                    const char *message)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("SREM %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SREM %s %s error: reply is nullptr", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SREM %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SREM %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
+    report_error(cmd, key, error, message);
+    if (admission_) {
+        admission_->record_failure(error);
     }
-
-    return reply->integer;
 }
 
-int PRedisClient::sismember(const std::string &key, const std::string &value)
+/*
+ * 字节数取 context 的累计读写量之差, 包括重试和丢弃的迟到回复
+ */
+redisReply *PRedisClient::exec_command(const char *cmd, PStringRef key, int expect_type)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("SISMEMBER %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SISMEMBER %s %s error: reply is nullptr", key.c_str(), value.c_str());
-        return -1;
+    if ((!metrics_ && !call_sites_ && !slowlog_) || nullptr == redis_context_) {
+        return run_command(cmd, key, expect_type);
+    }
+    if (slowlog_) {
+        slowlog_->poll_dump();
+    }
+
+    uint64_t start    = predis_now_us();
+    uint64_t written  = redis_context_->nwritten;
+    uint64_t read     = redis_context_->nread;
+    redisReply *r     = run_command(cmd, key, expect_type);
+
+    uint64_t elapsed  = predis_now_us() - start;
+    uint64_t sent     = redis_context_->nwritten - written;
+    uint64_t received = redis_context_->nread - read;
+    if (metrics_) {
+        PRedisCommandMetrics &m = metrics_->command(metrics_endpoint(), cmd);
+        predis_metric_add(m.ops, 1);
+        if (nullptr == r) {
+            predis_metric_add(m.errors, 1);
+        } else if (r->type == REDIS_REPLY_NIL) {
+            predis_metric_add(m.nils, 1);
+        }
+        predis_metric_add(m.bytes_sent, sent);
+        predis_metric_add(m.bytes_received, received);
+        m.latency.record(elapsed);
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SISMEMBER %s %s error", key.c_str(), value.c_str());
-        return -1;
+    if (call_sites_) {
+        call_sites_->record(call_site_, cmd, nullptr == r, sent, received, elapsed);
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("SISMEMBER %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
+    if (slowlog_ && slowlog_->is_slow(elapsed)) {
+        record_slow(elapsed, received);
     }
 
-    return reply->integer;
+    return r;
 }
 
-int PRedisClient::smembers(std::string const &key, std::vector<std::string> &values)
+redisReply *PRedisClient::run_command(const char *cmd, PStringRef key, int expect_type)
 {
-    if (!is_init_ok()) { return -1; }
+    PRedisAllocScope alloc_scope(cmd);
+    PRedisCommandCounters &counters = command_stats_.get(cmd);
+    ++counters.calls;
+    last_error_ = PREDIS_OK;
 
-    reply = redisCommand("SMEMBERS %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SMEMBERS %s error: reply is nullptr", key.c_str());
-        return -1;
+    if (nullptr == redis_context_) {
+        fail_before_send(cmd, key, PREDIS_ERR_NOT_CONNECTED, "not connected");
+        return nullptr;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SMEMBERS %s error", key.c_str());
-        return -1;
+    if (endpoint_ && endpoint_->generation() != endpoint_generation_) {
+        follow_endpoint();
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("SMEMBERS %s error: type is not REDIS_REPLY_ARRAY", key.c_str());
-        return -1;
+    if (redis_context_->err && !(health_options_.lazy_reconnect && try_reconnect())) {
+        fail_before_send(cmd, key, PREDIS_ERR_NOT_CONNECTED, "reconnecting");
+        return nullptr;
     }
+    last_used_us_ = predis_now_us();
 
-    for (int i = 0; i < reply->elements; i++) {
-        values.push_back(reply->element[i]->str);
+    reply_.reset();
+    if (!reply_pool_.attached(redis_context_)) {
+        reply_pool_.attach(redis_context_);
     }
 
-    return reply->elements;
-}
-
-int PRedisClient::spop(const std::string &key, std::string &value)
-{
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("SPOP %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("SPOP %s error: reply is nullptr", key.c_str());
-        return -1;
+    uint64_t start       = predis_now_us();
+    uint64_t deadline_us = deadline_.at_us;
+    /* 阻塞命令的自适应超时从阻塞结束时算起, 一直阻塞 (block_ms 为 0) 时不限制 */
+    if (adaptive_deadline_ && block_ms_ != 0) {
+        uint64_t adaptive_us = start + adaptive_deadline_->timeout_us(cmd);
+        if (block_ms_ > 0) {
+            adaptive_us += static_cast<uint64_t>(block_ms_) * 1000ULL;
+        }
+        if (0 == deadline_us || adaptive_us < deadline_us) {
+            deadline_us = adaptive_us;
+        }
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("SPOP %s error", key.c_str());
-        return -1;
+    if (deadline_.cancel != nullptr && deadline_.cancel->cancelled()) {
+        report_error(cmd, key, PREDIS_ERR_CANCELLED, "cancelled before send");
+        return nullptr;
     }
-    if (reply->type == REDIS_REPLY_NIL) {
-        pc_log_info("SPOP %s info: type is REDIS_REPLY_NIL");
-        return 0;
+    if (deadline_us != 0 && start >= deadline_us) {
+        fail_before_send(cmd, key, PREDIS_ERR_TIMEOUT, "deadline exceeded before send");
+        return nullptr;
     }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("SPOP %s error: type is not REDIS_REPLY_STRING", key.c_str());
-        return -1;
+    /* 迟到的回复太多时换一条连接; 重连不成功时仍可用, 迟到的回复到达时丢弃 */
+    if (stale_replies_ > s_max_stale_replies && health_options_.lazy_reconnect
+            && !try_reconnect() && redis_context_->err) {
+        fail_before_send(cmd, key, PREDIS_ERR_NOT_CONNECTED, "reconnecting");
+        return nullptr;
     }
 
-    value = reply->str;
-
-    return 1;
-}
+    if (admission_) {
+        PRedisError admitted = admission_->admit();
+        if (admitted != PREDIS_OK) {
+            report_error(cmd, key, admitted, predis_error_name(admitted));
+            return nullptr;
+        }
+    }
 
-int PRedisClient::hset(const std::string &key, const std::string &field, const std::string &value)
-{
-    if (!is_init_ok()) { return -1; }
+    PRedisError error = retry_round_trip(cmd, deadline_us, counters);
+    PREDIS_PROBE4(command, redis_context_->fd, cmd, static_cast<int>(error), predis_now_us() - start);
+    if (admission_) {
+        admission_->complete(error, predis_now_us() - start, block_ms_ >= 0);
+    }
+    if (error != PREDIS_OK) {
+        report_error(cmd, key, error,
+                     error == PREDIS_ERR_IO ? redis_context_->errstr : predis_error_name(error));
+        return nullptr;
+    }
+    if (adaptive_deadline_ && block_ms_ < 0) {
+        adaptive_deadline_->add(cmd, static_cast<uint32_t>(predis_now_us() - start));
+    }
+    phase_timer_.finish(cmd);
 
-    reply = redisCommand("HSET %s %s %s", key.c_str(), field.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HSET %s %s %s error: reply is nullptr", key.c_str(), field.c_str(), value.c_str());
-        return -1;
+    if (reply_->type == REDIS_REPLY_ERROR) {
+        report_error(cmd, key, PREDIS_ERR_REPLY, reply_->str);
+        return nullptr;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HSET %s %s %s error", key.c_str(), field.c_str(), value.c_str());
-        return -1;
+    if (reply_->type == REDIS_REPLY_NIL) {
+        ++counters.nils;
+        return reply_.get();
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HSET %s %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str(), value.c_str());
-        return -1;
+    if (reply_->type != expect_type) {
+        report_error(cmd, key, PREDIS_ERR_TYPE, "unexpected reply type");
+        return nullptr;
     }
 
-    return reply->integer;
+    return reply_.get();
 }
 
-int PRedisClient::hsetnx(const std::string &key, const std::string &field, const std::string &value)
+/*
+ * 重连和 health_check 一样走 try_reconnect, 受退避和重连令牌限制;
+ * 没到时间、没有令牌或重连失败时不再重试, 直接返回
+ */
+PRedisError PRedisClient::retry_round_trip(const char *cmd, uint64_t deadline_us,
+                                           PRedisCommandCounters &counters)
 {
-    if (!is_init_ok()) { return -1; }
+    const PRedisRetryPolicy &policy = retry_policies_.get(cmd);
+    for (uint32_t attempt = 1; ; ++attempt) {
+        PRedisError error = round_trip(deadline_us, deadline_.cancel);
+        if (error != PREDIS_ERR_IO || attempt >= policy.max_attempts) {
+            return error;
+        }
 
-    reply = redisCommand("HSETNX %s %s %s", key.c_str(), field.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HSETNX %s %s %s error: reply is nullptr", key.c_str(), field.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HSETNX %s %s %s error", key.c_str(), field.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HSETNX %s %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str(), value.c_str());
-        return -1;
+        uint32_t delay_ms = backoff_.delay_ms(policy, attempt);
+        if (deadline_us != 0 && predis_now_us() + delay_ms * 1000ULL >= deadline_us) {
+            return PREDIS_ERR_TIMEOUT;
+        }
+        ++counters.retries;
+        PRedisBackoff::sleep_ms(delay_ms);
+        if (!try_reconnect()) {
+            return error;
+        }
     }
-
-    return reply->integer;
 }
 
-int PRedisClient::hmset(const std::string &key, const std::vector< std::pair<std::string, std::string> > &field_value_pairs)
+/*
+ * 采样的命令走 wait_reply, 写、等待、解析分开计时
+ */
+PRedisError PRedisClient::round_trip(uint64_t deadline_us, const PRedisCancelToken *cancel)
 {
-    if (!is_init_ok()) { return -1; }
-
-    std::string redis_msg;
-    for (auto field : field_value_pairs) {
-        redis_msg += field.first;
-        redis_msg += " ";
-        redis_msg += field.second;
-        redis_msg += " ";
-    }  
+    phase_timer_.mark(PREDIS_PHASE_FORMAT);
+    if (REDIS_OK != redisAppendFormattedCommand(redis_context_, cmd_buf_.data(), cmd_buf_.size())) {
+        return PREDIS_ERR_IO;
+    }
+    phase_timer_.mark(PREDIS_PHASE_APPEND);
+
+    for (;;) {
+        void *r = nullptr;
+        PRedisError error = PREDIS_OK;
+        if (0 == deadline_us && nullptr == cancel && !phase_timer_.sampling()) {
+            error = REDIS_OK == redisGetReply(redis_context_, &r) ? PREDIS_OK : PREDIS_ERR_IO;
+            phase_timer_.mark(PREDIS_PHASE_WAIT);
+        } else {
+            error = wait_reply(deadline_us, cancel, &r);
+        }
+        if (error != PREDIS_OK) {
+            if (error != PREDIS_ERR_IO) {
+                ++stale_replies_;
+            }
+            return error;
+        }
 
-    reply = redisCommand("HMSET %s %s", key.c_str(), redis_msg.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HMSET %s %s error: reply is nullptr", key.c_str(), redis_msg.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HMSET %s %s %s error", key.c_str(), redis_msg.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("HMSET %s %s error: type is not REDIS_REPLY_STRING", key.c_str(), redis_msg.c_str());
-        return -1;
-    }
-    if (0 != strcmp("OK", reply->str)) {
-        return 0;
+        reply_.reset(static_cast<redisReply *>(r), redis_context_->reader->fn->freeObject);
+        if (0 == stale_replies_) {
+            return PREDIS_OK;
+        }
+        --stale_replies_;
+        reply_.reset();
     }
-    
-    return 1;
 }
 
-int PRedisClient::hmget(std::string const &key, const std::vector<std::string> &fields, std::vector<std::string> &values)
+/*
+ * 等待用 poll, 在 libpc 中只挂起当前协程; 取消标记只能在检查点看到,
+ * 所以有取消标记时 poll 最多等 s_cancel_check_ms
+ */
+PRedisError PRedisClient::wait_reply(uint64_t deadline_us, const PRedisCancelToken *cancel,
+                                     void **reply)
 {
-    if (!is_init_ok()) { return -1; }
+    int done = 0;
+    while (!done) {
+        if (REDIS_OK != redisBufferWrite(redis_context_, &done)) {
+            return PREDIS_ERR_IO;
+        }
+    }
+    phase_timer_.mark(PREDIS_PHASE_WRITE);
+
+    for (;;) {
+        if (REDIS_OK != redisGetReplyFromReader(redis_context_, reply)) {
+            return PREDIS_ERR_IO;
+        }
+        phase_timer_.mark(PREDIS_PHASE_PARSE);
+        if (*reply != nullptr) {
+            return PREDIS_OK;
+        }
+        if (cancel != nullptr && cancel->cancelled()) {
+            return PREDIS_ERR_CANCELLED;
+        }
+
+        int wait_ms = -1;
+        if (deadline_us != 0) {
+            uint64_t now = predis_now_us();
+            if (now >= deadline_us) {
+                return PREDIS_ERR_TIMEOUT;
+            }
+            wait_ms = static_cast<int>((deadline_us - now + 999) / 1000);
+        }
+        if (cancel != nullptr && (wait_ms < 0 || wait_ms > s_cancel_check_ms)) {
+            wait_ms = s_cancel_check_ms;
+        }
 
-    std::string redis_msg;
-    for (auto field : fields) {
-        redis_msg += field;
-        redis_msg += " ";
+        struct pollfd pfd;
+        pfd.fd      = redis_context_->fd;
+        pfd.events  = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, wait_ms);
+        if (ready < 0 && errno != EINTR) {
+            redis_context_->err = REDIS_ERR_IO;
+            snprintf(redis_context_->errstr, sizeof(redis_context_->errstr), "poll: %s", strerror(errno));
+            return PREDIS_ERR_IO;
+        }
+        if (ready > 0 && REDIS_OK != redisBufferRead(redis_context_)) {
+            return PREDIS_ERR_IO;
+        }
+        phase_timer_.mark(PREDIS_PHASE_WAIT);
     }
+}
 
-    reply = redisCommand("HMGET %s %s", key.c_st(), redis_msg.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HMGET %s %s error: reply is nullptr", key.c_str(), redis_msg.c_str());
-        return -1;
+void PRedisClient::reconnect()
+{
+    stale_replies_ = 0;
+    if (metrics_) {
+        predis_metric_add(metrics_endpoint()->reconnects, 1);
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HMSET %s %s %s error", key.c_str(), redis_msg.c_str());
-        return -1;
+    if (REDIS_OK == redisReconnect(redis_context_)) {
+        reply_pool_.attach(redis_context_);
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("HMSET %s %s error: type is not REDIS_REPLY_ARRAY", key.c_str(), redis_msg.c_str());
+}
+
+int PRedisClient::exec_integer(const char *cmd, PStringRef key, long long &value)
+{
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_INTEGER);
+    if (nullptr == r || r->type != REDIS_REPLY_INTEGER) {
         return -1;
     }
-    for (int i = 0; i < reply->elements; i++) {
-        values.push_back(reply->element[i]->str);
-    }
-    return reply->elements;
+    value = r->integer;
+
+    return 0;
 }
 
-int PRedisClient::hget(const std::string &key, const std::string &field, std::string &value)
+int PRedisClient::exec_count(const char *cmd, PStringRef key)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("HGET %s %s", key.c_str(), field.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HGET %s %s error: reply is nullptr", key.c_str(), field.c_str());
+    long long value = 0;
+    if (0 != exec_integer(cmd, key, value)) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HGET %s %s error", key.c_str(), field.c_str());
+
+    return static_cast<int>(value);
+}
+
+int PRedisClient::exec_status(const char *cmd, PStringRef key)
+{
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_STATUS);
+    if (nullptr == r || r->type != REDIS_REPLY_STATUS) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_NIL) {
+    if (r->len != 2 || 0 != memcmp(r->str, "OK", 2)) {
+        report_error(cmd, key, PREDIS_ERR_REPLY, r->str);
         return 0;
     }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("HGET %s %s error: type is not REDIS_REPLY_STRING", key.c_str(), field.c_str());
-        return -1;
-    }
-    value = reply->str;
 
     return 1;
 }
 
-int PRedisClient::hgetall(const std::string &key, std::vector< std::pair<std::string, std::string> > &field_value_pairs)
+int PRedisClient::exec_string(const char *cmd, PStringRef key, std::string &value)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("HGETALL %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HGETALL %s error: reply is nullptr", key.c_str());
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_STRING);
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HGETALL %s error", key.c_str());
-        return -1;
+    if (r->type == REDIS_REPLY_NIL) {
+        return 0;
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("HGETALL %s error: type is not REDIS_REPLY_ARRAY", key.c_str());
+    value.assign(r->str, r->len);
+    phase_timer_.decoded();
+
+    return 1;
+}
+
+int PRedisClient::exec_strings(const char *cmd, PStringRef key, std::vector<std::string> &values)
+{
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_ARRAY);
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->elements % 2 != 0) {
-        pc_log_error("HGETALL %s error: elements is %d", key.c_str(), reply->elements);
-        return -1;
+    if (r->type == REDIS_REPLY_NIL) {
+        return 0;
     }
-    for (int i = 0; i < reply->elements; i += 2) {
-        std::pair<std::string, std::string> value_pair;
-        value_pair.first  = reply->element[i]->str;
-        value_pair.second = reply->element[i+1]->str;
+
+    values.reserve(values.size() + r->elements);
+    for (size_t i = 0; i < r->elements; ++i) {
+        const redisReply *item = r->element[i];
+        if (item->type == REDIS_REPLY_STRING || item->type == REDIS_REPLY_STATUS) {
+            values.emplace_back(item->str, item->len);
+        } else {
+            values.emplace_back();
+        }
     }
+    phase_timer_.decoded();
 
-    return reply->elements;
+    return static_cast<int>(r->elements);
 }
 
-int PRedisClient::hexists(const std::string &key, const std::string &field)
+/*
+ * 与 exec_strings 相同, 字符串元素按压缩格式还原; NIL 元素为空串
+ */
+int PRedisClient::exec_values(const char *cmd, PStringRef key, std::vector<std::string> &values)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("HEXISTS %s %s", key.c_str(), field.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HEXISTS %s %s error: reply is nullptr", key.c_str(), field.c_str());
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_ARRAY);
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HSET %s %s error", key.c_str(), field.c_str());
-        return -1;
+    if (r->type == REDIS_REPLY_NIL) {
+        return 0;
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HSET %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str());
-        return -1;
+
+    values.reserve(values.size() + r->elements);
+    for (size_t i = 0; i < r->elements; ++i) {
+        PStringRef data;
+        if (0 != read_element(r->element[i], data)) {
+            return report_error(cmd, key, PREDIS_ERR_DECODE, compressor_->error());
+        }
+        values.emplace_back(data.data(), data.size());
     }
+    phase_timer_.decoded();
 
-    return reply->integer;
+    return static_cast<int>(r->elements);
 }
 
-int PRedisClient::hdel(const std::string &key, const std::string &field)
+PRedisError PRedisClient::last_error() const
 {
-    if (!is_init_ok()) { return -1; }
+    return last_error_;
+}
 
-    reply = redisCommand("HDEL %s %s", key.c_str(), field.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HDEL %s %s error: reply is nullptr", key.c_str(), field.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HDEL %s %s error", key.c_str(), field.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HDEL %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str());
-        return -1;
-    }
+const std::string &PRedisClient::last_error_message() const
+{
+    return last_error_message_;
+}
 
-    return reply->integer;
+const std::vector<PRedisCommandCounters> &PRedisClient::command_counters() const
+{
+    return command_stats_.counters();
 }
 
-int PRedisClient::hdel(const std::string &key, const std::vector<std::string> &fields)
+void PRedisClient::set_error_log_limit(uint32_t limit_per_second)
 {
-    if (!is_init_ok()) { return -1; }
+    error_log_.set_limit(limit_per_second);
+}
 
-    std::string field;
-    for (auto field_ : fields) {
-        field += field_;
-        field += " ";
-    }
+void PRedisClient::set_retry_policy(const PRedisRetryPolicy &policy)
+{
+    retry_policies_.set_default(policy);
+}
 
-    reply = redisCommand("HDEL %s %s", key.c_str(), field.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HDEL %s %s error: reply is nullptr", key.c_str(), field.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HDEL %s %s error", key.c_str(), field.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HDEL %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str());
-        return -1;
-    }
+void PRedisClient::set_retry_policy(const char *cmd, const PRedisRetryPolicy &policy)
+{
+    retry_policies_.set(cmd, policy);
+}
 
-    return reply->integer;
+void PRedisClient::set_deadline(const PRedisDeadline &deadline)
+{
+    deadline_ = deadline;
 }
 
-int PRedisClient::hkeys(const std::string &key, std::vector<std::string> &out)
+const PRedisDeadline &PRedisClient::deadline() const
 {
-    if (!is_init_ok()) { return -1; }
+    return deadline_;
+}
 
-    reply = redisCommand("HKEYS %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HKEYS %s error: reply is nullptr", key.c_str());
-        return -1;
+void PRedisClient::set_adaptive_deadline(const PRedisAdaptiveDeadlineOptions &options)
+{
+    adaptive_deadline_.reset(new PRedisAdaptiveDeadline(options));
+}
+
+void PRedisClient::set_admission(const std::shared_ptr<PRedisAdmission> &admission)
+{
+    admission_ = admission;
+}
+
+void PRedisClient::append_value(PRespWriter &writer, PStringRef value)
+{
+    if (!compressor_) {
+        writer.arg(value);
+        return;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HKEYS %s error", key.c_str());
-        return -1;
+    if (0 != compressor_->write_arg(writer, value)) {
+        log_compress_error();
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("HKEYS %s error: type is not REDIS_REPLY_ARRAY", key.c_str());
-        return -1;
+}
+
+/*
+ * 压缩出错时值按原值写入, 命令照常执行, 只输出限流的日志
+ */
+void PRedisClient::log_compress_error()
+{
+    if (error_log_.allow()) {
+        pc_log_error("compress error: %s, value stored uncompressed", compressor_->error());
     }
-    for (int i = 0; i < reply->elements; ++i) {
-        out.push_back(reply->element[i]->str);
+}
+
+int PRedisClient::read_value(PStringRef stored, PStringRef &value)
+{
+    if (compressor_) {
+        return compressor_->read(stored, value);
     }
+    value = stored;
 
-    return reply->elements;
+    return 0;
 }
 
-int PRedisClient::hvals(const std::string &key, std::vector<std::string> &out)
+int PRedisClient::exec_value(const char *cmd, PStringRef key, std::string &value)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("HVALS %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HVALS %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HVALS %s error", key.c_str());
+    redisReply *r = exec_command(cmd, key, REDIS_REPLY_STRING);
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("HVALS %s error: type is not REDIS_REPLY_ARRAY", key.c_str());
-        return -1;
+    if (r->type == REDIS_REPLY_NIL) {
+        return 0;
     }
-    for (int i = 0; i < reply->elements; ++i) {
-        out.push_back(reply->element[i]->str);
+
+    PStringRef data;
+    if (0 != read_value(PStringRef(r->str, r->len), data)) {
+        return report_error(cmd, key, PREDIS_ERR_DECODE, compressor_->error());
     }
+    value.assign(data.data(), data.size());
+    phase_timer_.decoded();
 
-    return reply->elements;
+    return 1;
 }
 
-int PRedisClient::hlen(const std::string &key)
+int PRedisClient::set(PStringRef key, PStringRef value)
 {
-    if (!is_init_ok()) { return -1; }
+    PRespWriter writer = begin_command(3);
+    writer.arg("SET", 3).arg(key);
+    append_value(writer, value);
+    return exec_status("SET", key);
+}
 
-    reply = redisCommand("HLEN %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HLEN %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HLEN %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HLEN %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
-        return -1;
-    }
+int PRedisClient::setnx(PStringRef key, PStringRef value)
+{
+    PRespWriter writer = begin_command(3);
+    writer.arg("SETNX", 5).arg(key);
+    append_value(writer, value);
+    return exec_count("SETNX", key);
+}
 
-    return reply->integer;
+int PRedisClient::setex(PStringRef key, uint32_t seconds, PStringRef value)
+{
+    PRespWriter writer = begin_command(4);
+    writer.arg("SETEX", 5).arg(key).arg(static_cast<long long>(seconds));
+    append_value(writer, value);
+    return exec_status("SETEX", key);
 }
 
-int PRedisClient::hincrby(const std::string &key, const std::string &field,
-            const std::string &value, long long &res)
+long long PRedisClient::incr(PStringRef key)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(2).arg("INCR", 4).arg(key);
 
-    reply = redisCommand("HINCRBY %s %s %s", key.c_str(), field.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("HINCRBY %s %s %s error: reply is nullptr", key.c_str(), field.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HLEN %s error", key.c_str(), field.c_str(), value.c_str());
+    long long value = 0;
+    if (0 != exec_integer("INCR", key, value)) {
         return -1;
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("HLEN %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), field.c_str(), value.c_str());
-        return -1;
-    }
-    res = reply->integer;
 
-    return 1;
+    return value;
 }
 
-int PRedisClient::lpush(std::string const &key, std::string const &value)
+int PRedisClient::mset(const std::vector<std::pair<std::string, std::string> > &fields)
 {
-    if (!is_init_ok()) { return -1; }
+    return mset(fields.begin(), fields.end());
+}
 
-    reply = redisCommand("LPUSH %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LPUSH %s %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LPUSH %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("LPUSH %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
-    }
+int PRedisClient::mget(const std::vector<std::string> &keys, std::vector<std::string> &values)
+{
+    return mget(keys.begin(), keys.end(), values);
+}
 
-    return reply->integer;
+int PRedisClient::get(PStringRef key, std::string &value)
+{
+    begin_command(2).arg("GET", 3).arg(key);
+    return exec_value("GET", key, value);
 }
 
-int PRedisClient::lpush(std::string const &key, const std::vector<std::string> &values)
+int PRedisClient::del(PStringRef key)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(2).arg("DEL", 3).arg(key);
+    return exec_count("DEL", key);
+}
 
-    std::string value;
-    for (auto value_ : values) {
-        value += value_;
-        value += " ";
-    }
+int PRedisClient::del(const std::vector<std::string> &keys)
+{
+    return del(keys.begin(), keys.end());
+}
 
-    reply = redisCommand("LPUSH %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LPUSH %s %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LPUSH %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("LPUSH %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
+long int PRedisClient::dbsize()
+{
+    begin_command(1).arg("DBSIZE", 6);
+
+    long long value = 0;
+    if (0 != exec_integer("DBSIZE", PStringRef(), value)) {
         return -1;
     }
 
-    return reply->integer;  
+    return static_cast<long int>(value);
 }
 
-int PRedisClient::lpushx(std::string const &key, std::string const &value)
+int PRedisClient::expire(PStringRef key, uint32_t secs)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("EXPIRE", 6).arg(key).arg(static_cast<long long>(secs));
+    return exec_count("EXPIRE", key);
+}
 
-    reply = redisCommand("LPUSHX %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LPUSHX %s %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LPUSHX %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("LPUSHX %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
-    }
+int PRedisClient::keys(PStringRef pattern, std::vector<std::string> &out)
+{
+    begin_command(2).arg("KEYS", 4).arg(pattern);
+    return exec_strings("KEYS", pattern, out);
+}
 
-    return reply->integer;
+int PRedisClient::exists(PStringRef key)
+{
+    begin_command(2).arg("EXISTS", 6).arg(key);
+    return exec_count("EXISTS", key);
 }
 
-int PRedisClient::rpush(std::string const &key, std::string const &value)
+int PRedisClient::sadd(PStringRef key, PStringRef value)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("SADD", 4).arg(key).arg(value);
+    return exec_count("SADD", key);
+}
 
-    reply = redisCommand("RPUSH %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("RPUSH %s %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("RPUSH %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("RPUSH %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
-    }
+int PRedisClient::sadd(PStringRef key, const std::vector<std::string> &values)
+{
+    return sadd(key, values.begin(), values.end());
+}
 
-    return reply->integer;
+int PRedisClient::srem(PStringRef key, PStringRef value)
+{
+    begin_command(3).arg("SREM", 4).arg(key).arg(value);
+    return exec_count("SREM", key);
 }
 
-int PRedisClient::rpush(std::string const &key, const std::vector<std::string> &values)
+int PRedisClient::sismember(PStringRef key, PStringRef value)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("SISMEMBER", 9).arg(key).arg(value);
+    return exec_count("SISMEMBER", key);
+}
 
-    std::string value;
-    for (auto value_ : values) {
-        value += value_;
-        value += " ";
-    }
+int PRedisClient::smembers(PStringRef key, std::vector<std::string> &values)
+{
+    begin_command(2).arg("SMEMBERS", 8).arg(key);
+    return exec_strings("SMEMBERS", key, values);
+}
 
-    reply = redisCommand("RPUSH %s %s", key.c_str(), value.c_str());
-    if (nullptr == reply) {
-        pc_log_error("RPUSH %s %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("RPUSH %s %s error", key.c_str(), value.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("RPUSH %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), value.c_str());
-        return -1;
-    }
+int PRedisClient::spop(PStringRef key, std::string &value)
+{
+    begin_command(2).arg("SPOP", 4).arg(key);
+    return exec_string("SPOP", key, value);
+}
 
-    return reply->integer;  
+int PRedisClient::hset(PStringRef key, PStringRef field, PStringRef value)
+{
+    PRespWriter writer = begin_command(4);
+    writer.arg("HSET", 4).arg(key).arg(field);
+    append_value(writer, value);
+    return exec_count("HSET", key);
 }
 
-int PRedisClient::llen(const std::string &key)
+int PRedisClient::hsetnx(PStringRef key, PStringRef field, PStringRef value)
 {
-    if (!is_init_ok()) { return -1; }
+    PRespWriter writer = begin_command(4);
+    writer.arg("HSETNX", 6).arg(key).arg(field);
+    append_value(writer, value);
+    return exec_count("HSETNX", key);
+}
 
-    reply = redisCommand("LLEN %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LLEN %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LLEN %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("LLEN %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
-        return -1;
-    }
+int PRedisClient::hmset(PStringRef key,
+        const std::vector< std::pair<std::string, std::string> > &field_value_pairs)
+{
+    return hmset(key, field_value_pairs.begin(), field_value_pairs.end());
+}
+
+int PRedisClient::hmget(PStringRef key, const std::vector<std::string> &fields,
+        std::vector<std::string> &values)
+{
+    return hmget(key, fields.begin(), fields.end(), values);
+}
 
-    return reply->integer;
+int PRedisClient::hget(PStringRef key, PStringRef field, std::string &value)
+{
+    begin_command(3).arg("HGET", 4).arg(key).arg(field);
+    return exec_value("HGET", key, value);
 }
 
-int PRedisClient::lrange(std::string const &key, int start, int stop,
-                         std::vector<std::string> &values)
+int PRedisClient::hgetall(PStringRef key,
+        std::vector< std::pair<std::string, std::string> > &field_value_pairs)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(2).arg("HGETALL", 7).arg(key);
 
-    reply = redisCommand("LRANGE %s %d %d", key.c_str(), start, stop);
-    if (nullptr == reply) {
-        pc_log_error("LRANGE %s %d %d error: reply is nullptr", key.c_str(), start, stop);
+    redisReply *r = exec_command("HGETALL", key, REDIS_REPLY_ARRAY);
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LRANGE %s %d %d error", key.c_str(), start, stop);
-        return -1;
+    if (r->type == REDIS_REPLY_NIL) {
+        return 0;
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("LRANGE %s %d %d error: reply is nullptr", key.c_str(), start, stop);
-        return -1;
+    if (r->elements % 2 != 0) {
+        return report_error("HGETALL", key, PREDIS_ERR_TYPE, "odd number of elements");
     }
 
-    for (int i = 0; i < reply->elements; ++i) {
-        values.push_back(reply->element[i]->str);
+    field_value_pairs.reserve(field_value_pairs.size() + r->elements / 2);
+    for (size_t i = 0; i < r->elements; i += 2) {
+        PStringRef value;
+        if (0 != read_element(r->element[i+1], value)) {
+            return report_error("HGETALL", key, PREDIS_ERR_DECODE, compressor_->error());
+        }
+        field_value_pairs.emplace_back(std::string(r->element[i]->str, r->element[i]->len),
+                                       std::string(value.data(), value.size()));
     }
+    phase_timer_.decoded();
 
-    return reply->elements;
+    return static_cast<int>(r->elements / 2);
 }
 
-int PRedisClient::lpop(std::string const &key, std::string &value)
+int PRedisClient::hexists(PStringRef key, PStringRef field)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("HEXISTS", 7).arg(key).arg(field);
+    return exec_count("HEXISTS", key);
+}
 
-    reply = redisCommand("LPOP %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LPOP %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HGET %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_NIL) {
-        return 0;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("LPOP %s error: type is not REDIS_REPLY_STRING", key.c_str());
-        return -1;
-    }
-    value = reply->str;
+int PRedisClient::hdel(PStringRef key, PStringRef field)
+{
+    begin_command(3).arg("HDEL", 4).arg(key).arg(field);
+    return exec_count("HDEL", key);
+}
 
-    return 1;
+int PRedisClient::hdel(PStringRef key, const std::vector<std::string> &fields)
+{
+    return hdel(key, fields.begin(), fields.end());
 }
 
-int PRedisClient::rpop(std::string const &key, std::string &value)
+int PRedisClient::hkeys(PStringRef key, std::vector<std::string> &out)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(2).arg("HKEYS", 5).arg(key);
+    return exec_strings("HKEYS", key, out);
+}
 
-    reply = redisCommand("LPOP %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("LPOP %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("HGET %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_NIL) {
-        return 0;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("LPOP %s error: type is not REDIS_REPLY_STRING", key.c_str());
+int PRedisClient::hvals(PStringRef key, std::vector<std::string> &out)
+{
+    begin_command(2).arg("HVALS", 5).arg(key);
+    return exec_values("HVALS", key, out);
+}
+
+int PRedisClient::hlen(PStringRef key)
+{
+    begin_command(2).arg("HLEN", 4).arg(key);
+    return exec_count("HLEN", key);
+}
+
+int PRedisClient::hincrby(PStringRef key, PStringRef field,
+            PStringRef value, long long &res)
+{
+    begin_command(4).arg("HINCRBY", 7).arg(key).arg(field).arg(value);
+    if (0 != exec_integer("HINCRBY", key, res)) {
         return -1;
     }
-    value = reply->str;
 
     return 1;
 }
 
-int PRedisClient::ltrim(std::string const &key, int start, int stop)
+int PRedisClient::lpush(PStringRef key, PStringRef value)
 {
-    if (!is_init_ok()) { return -1 };
+    begin_command(3).arg("LPUSH", 5).arg(key).arg(value);
+    return exec_count("LPUSH", key);
+}
 
-    reply = redisCommand(redis_context_, "LTRIM %s %d %d", key.c_str(), start, stop);
-    if (nullptr == reply) {
-        pc_log_error("LTRIM %s %d %d error: reply is nullptr", key.c_str(), start, stop);
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("LTRIM %s %d %d error", key.c_str(), start, stop);
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("LTRIM %s %d %d error: reply type is not REDIS_REPLY_STRING",
-                     key.c_str(), start, stop);
-    }
+int PRedisClient::lpush(PStringRef key, const std::vector<std::string> &values)
+{
+    return lpush(key, values.begin(), values.end());
+}
 
-    if (0 != strcmp(reply->str, "OK")) {
-        return 0;
-    }
+int PRedisClient::lpushx(PStringRef key, PStringRef value)
+{
+    begin_command(3).arg("LPUSHX", 6).arg(key).arg(value);
+    return exec_count("LPUSHX", key);
+}
 
-    return 1;
+int PRedisClient::rpush(PStringRef key, PStringRef value)
+{
+    begin_command(3).arg("RPUSH", 5).arg(key).arg(value);
+    return exec_count("RPUSH", key);
 }
 
-int PRedisClient::zadd(std::string const &key, int64_t score, std::string const &member)
+int PRedisClient::rpush(PStringRef key, const std::vector<std::string> &values)
 {
-    if (!is_init_ok()) { return -1; }
+    return rpush(key, values.begin(), values.end());
+}
 
-    reply = redisCommand("ZADD %s %ld %s", key.c_str(), score, member.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZADD %s %ld %s error: reply is nullptr", key.c_str(), score, member.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZADD %s %ld %s error", key.c_str(), score, member.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZADD %s %ld %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), score, member.c_str());
-        return -1;
-    }
+int PRedisClient::llen(PStringRef key)
+{
+    begin_command(2).arg("LLEN", 4).arg(key);
+    return exec_count("LLEN", key);
+}
 
-    return reply->integer;
+int PRedisClient::lrange(PStringRef key, int start, int stop,
+        std::vector<std::string> &values)
+{
+    begin_command(4).arg("LRANGE", 6).arg(key)
+                    .arg(static_cast<long long>(start)).arg(static_cast<long long>(stop));
+    return exec_strings("LRANGE", key, values);
 }
 
-int PRedisClient::zadd(std::string const &key,const std::vector<std::pair<int64_t, std::string> > &member_score_pair_v)
+int PRedisClient::lpop(PStringRef key, std::string &value)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(2).arg("LPOP", 4).arg(key);
+    return exec_string("LPOP", key, value);
+}
 
-    std::string score_member_str;
-    for (auto score_member : member_score_pair_v) {
-        score_member_str += score_member.first;
-        score_member_str += " ";
-        score_member_str += score_member.second;
-        score_member_str += " ";
-    }
+int PRedisClient::rpop(PStringRef key, std::string &value)
+{
+    begin_command(2).arg("RPOP", 4).arg(key);
+    return exec_string("RPOP", key, value);
+}
 
-    reply = redisCommand("ZADD %s %s", key.c_str(), score_member_str.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZADD %s %s error: reply is nullptr", key.c_str(), score_member_str.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZADD %s %s error", key.c_str(), score_member_str.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZADD %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), score_member_str.c_str());
-        return -1;
-    }
+int PRedisClient::lpop(PStringRef key, size_t count, std::vector<std::string> &values)
+{
+    return pop_count("LPOP", key, count, values);
+}
+
+int PRedisClient::rpop(PStringRef key, size_t count, std::vector<std::string> &values)
+{
+    return pop_count("RPOP", key, count, values);
+}
 
-    return reply->integer;
+int PRedisClient::pop_count(const char *cmd, PStringRef key, size_t count,
+        std::vector<std::string> &values)
+{
+    begin_command(3).arg(cmd, 4).arg(key).arg(static_cast<long long>(count));
+    return exec_strings(cmd, key, values);
 }
 
-int PRedisClient::zrem(std::string const &key, std::string const &member)
+int PRedisClient::lmove(PStringRef source, PStringRef destination,
+        PStringRef wherefrom, PStringRef whereto, std::string &value)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(5).arg("LMOVE", 5).arg(source).arg(destination).arg(wherefrom).arg(whereto);
+    return exec_string("LMOVE", source, value);
+}
 
-    reply = redisCommand("ZREM %s %s", key.c_str(), member.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZREM %s %s error: reply is nullptr", key.c_str(), member.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZREM %s %s error", key.c_str(), member.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZREM %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), member.c_str());
-        return -1;
-    }
+int PRedisClient::ltrim(PStringRef key, int start, int stop)
+{
+    begin_command(4).arg("LTRIM", 5).arg(key)
+                    .arg(static_cast<long long>(start)).arg(static_cast<long long>(stop));
+    return exec_status("LTRIM", key);
+}
 
-    return reply->integer;
+int PRedisClient::zadd(PStringRef key, int64_t score, PStringRef member)
+{
+    begin_command(4).arg("ZADD", 4).arg(key).arg(static_cast<long long>(score)).arg(member);
+    return exec_count("ZADD", key);
 }
 
-int PRedisClient::zrem(std::string const &key, std::vector<std::string> const &members)
+int PRedisClient::zadd(PStringRef key,
+        const std::vector<std::pair<int64_t, std::string> > &member_score_pair_v)
 {
-    if (!is_init_ok()) { return -1; }
+    return zadd(key, member_score_pair_v.begin(), member_score_pair_v.end());
+}
 
-    std::string member;
-    for (auto member_ : members) {
-        member += member_;
-        member += " ";
-    }
+int PRedisClient::zrem(PStringRef key, PStringRef member)
+{
+    begin_command(3).arg("ZREM", 4).arg(key).arg(member);
+    return exec_count("ZREM", key);
+}
 
-    reply = redisCommand("ZREM %s %s", key.c_str(), member.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZREM %s %s error: reply is nullptr", key.c_str(), member.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZREM %s %s error", key.c_str(), member.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZREM %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), member.c_str());
-        return -1;
-    }
+int PRedisClient::zrem(PStringRef key, std::vector<std::string> const &members)
+{
+    return zrem(key, members.begin(), members.end());
+}
 
-    return reply->integer;
+int PRedisClient::zcard(PStringRef key)
+{
+    begin_command(2).arg("ZCARD", 5).arg(key);
+    return exec_count("ZCARD", key);
 }
 
-int PRedisClient::zcard(std::string const &key)
+int PRedisClient::zscore(PStringRef key, PStringRef member, std::string &score)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("ZSCORE", 6).arg(key).arg(member);
+    return exec_string("ZSCORE", key, score);
+}
 
-    reply = redisCommand("ZCARD %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZREM %s error: reply is nullptr", key.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZREM %s error", key.c_str());
-        return -1;
-    }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZREM %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
+int PRedisClient::zrangebyscore(PStringRef key, PStringRef min_score,
+        PStringRef max_score, std::vector<std::string> &members)
+{
+    begin_command(4).arg("ZRANGEBYSCORE", 13).arg(key).arg(min_score).arg(max_score);
+    return exec_strings("ZRANGEBYSCORE", key, members);
+}
+
+int PRedisClient::zremrangebyscore(PStringRef key, PStringRef min_score, PStringRef max_score)
+{
+    begin_command(4).arg("ZREMRANGEBYSCORE", 16).arg(key).arg(min_score).arg(max_score);
+    return exec_count("ZREMRANGEBYSCORE", key);
+}
+
+int PRedisClient::ttl(PStringRef key, int &result)
+{
+    begin_command(2).arg("TTL", 3).arg(key);
+
+    long long value = 0;
+    if (0 != exec_integer("TTL", key, value)) {
         return -1;
     }
+    result = static_cast<int>(value);
 
-    return reply->integer;
+    return 0;
 }
 
-int PRedisClient::zscore(const std::string &key, const std::string &member, std::string &score)
+int PRedisClient::xadd(PStringRef key,
+        const std::vector< std::pair<std::string, std::string> > &fields,
+        std::string &id, size_t maxlen)
 {
-    if (!is_init_ok()) { return -1; }
+    return xadd(key, fields.begin(), fields.end(), id, maxlen);
+}
 
-    reply = redisCommand("ZSCORE %s %s", key.c_str(), member.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZSCORE %s %s error: reply is nullptr", key.c_str(), member.c_str());
-        return -1;
+int PRedisClient::xreadgroup(PStringRef group, PStringRef consumer,
+        PStringRef key, PStringRef id, size_t count,
+        int block_ms, std::vector<PRedisStreamEntry> &entries)
+{
+    PRespWriter writer = begin_command(block_ms >= 0 ? 11 : 9);
+    writer.arg("XREADGROUP", 10).arg("GROUP", 5).arg(group).arg(consumer)
+          .arg("COUNT", 5).arg(static_cast<long long>(count));
+    if (block_ms >= 0) {
+        writer.arg("BLOCK", 5).arg(static_cast<long long>(block_ms));
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZSCORE %s %s error", key.c_str(), member.c_str());
+    writer.arg("STREAMS", 7).arg(key).arg(id);
+
+    block_ms_ = block_ms;
+    redisReply *r = exec_command("XREADGROUP", key, REDIS_REPLY_ARRAY);
+    block_ms_ = -1;
+    if (nullptr == r) {
         return -1;
     }
-    if (reply->type != REDIS_REPLY_STRING) {
-        pc_log_error("ZSCORE %s %s error: type is not REDIS_REPLY_STRING", key.c_str(), member.c_str());
+    if (r->type == REDIS_REPLY_NIL) {
+        entries.clear();
+        return 0;
+    }
+    if (r->elements != 1 || r->element[0]->type != REDIS_REPLY_ARRAY
+            || r->element[0]->elements != 2) {
+        report_error("XREADGROUP", key, PREDIS_ERR_TYPE, "unexpected reply");
         return -1;
     }
-    score = reply->str;
 
-    return 1;
+    int ret = parse_stream_entries(r->element[0]->element[1], entries);
+    if (ret < 0) {
+        report_error("XREADGROUP", key, PREDIS_ERR_TYPE, "malformed entries");
+    }
+
+    return ret;
 }
 
-int PRedisClient::zrangebyscore(std::string const &key, std::string const &min_score,
-        std::string const &max_score, std::vector<std::string> &members)
+int PRedisClient::xack(PStringRef key, PStringRef group,
+        const std::vector<std::string> &ids)
 {
-    if (!is_init_ok()) { return -1; }
+    return xack(key, group, ids.begin(), ids.end());
+}
 
-    reply = redisCommand("ZRANGEBYSCORE %s %s %s", key.c_str(), min_score.c_str(), max_score.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZRANGEBYSCORE %s %s %s error: reply is nullptr", key.c_str(), min_score.c_str(), max_score.c_str());
-        return -1;
-    }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZRANGEBYSCORE %s %s %s error", key.c_str(), min_score.c_str(), max_score.c_str());
+int PRedisClient::xautoclaim(PStringRef key, PStringRef group,
+        PStringRef consumer, uint64_t min_idle_ms,
+        PStringRef start, size_t count, std::string &next_start,
+        std::vector<PRedisStreamEntry> &entries)
+{
+    begin_command(8).arg("XAUTOCLAIM", 10).arg(key).arg(group).arg(consumer)
+                    .arg(static_cast<long long>(min_idle_ms)).arg(start)
+                    .arg("COUNT", 5).arg(static_cast<long long>(count));
+
+    redisReply *r = exec_command("XAUTOCLAIM", key, REDIS_REPLY_ARRAY);
+    if (nullptr == r || r->type != REDIS_REPLY_ARRAY) {
         return -1;
     }
-    if (reply->type != REDIS_REPLY_ARRAY) {
-        pc_log_error("ZRANGEBYSCORE %s %s %s error: type is not REDIS_REPLY_ARRAY", key.c_str(), min_score.c_str(), max_score.c_str());
+    if (r->elements < 2 || r->element[0]->type != REDIS_REPLY_STRING) {
+        report_error("XAUTOCLAIM", key, PREDIS_ERR_TYPE, "unexpected reply");
         return -1;
     }
-    for (int i = 0; i < reply->elements; ++i) {
-        members.push_back(reply->element[i]->str);
+
+    next_start.assign(r->element[0]->str, r->element[0]->len);
+    int ret = parse_stream_entries(r->element[1], entries);
+    if (ret < 0) {
+        report_error("XAUTOCLAIM", key, PREDIS_ERR_TYPE, "malformed entries");
     }
 
-    return 1;
+    return ret;
 }
 
-int PRedisClient::zremrangebyscore(std::string const &key, std::string const &min_score, std::string const &max_score)
+int PRedisClient::xpending(PStringRef key, PStringRef group,
+        PRedisStreamPendingSummary &summary)
 {
-    if (!is_init_ok()) { return -1; }
+    begin_command(3).arg("XPENDING", 8).arg(key).arg(group);
 
-    reply = redisCommand("ZREMRANGEBYSCORE %s %s %s", key.c_str(), min_score.c_str(), max_score.c_str());
-    if (nullptr == reply) {
-        pc_log_error("ZREMRANGEBYSCORE %s %s %s error: reply is nullptr", key.c_str(), min_score.c_str(), max_score.c_str());
+    redisReply *r = exec_command("XPENDING", key, REDIS_REPLY_ARRAY);
+    if (nullptr == r || r->type != REDIS_REPLY_ARRAY) {
         return -1;
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("ZREMRANGEBYSCORE %s %s %s error", key.c_str(), min_score.c_str(), max_score.c_str());
+    if (r->elements != 4 || r->element[0]->type != REDIS_REPLY_INTEGER) {
+        report_error("XPENDING", key, PREDIS_ERR_TYPE, "unexpected reply");
         return -1;
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("ZREMRANGEBYSCORE %s %s %s error: type is not REDIS_REPLY_INTEGER", key.c_str(), min_score.c_str(), max_score.c_str());
-        return -1;
+
+    summary.count = r->element[0]->integer;
+    summary.min_id.clear();
+    summary.max_id.clear();
+    summary.consumers.clear();
+    if (r->element[1]->type == REDIS_REPLY_STRING) {
+        summary.min_id.assign(r->element[1]->str, r->element[1]->len);
+    }
+    if (r->element[2]->type == REDIS_REPLY_STRING) {
+        summary.max_id.assign(r->element[2]->str, r->element[2]->len);
+    }
+    if (r->element[3]->type == REDIS_REPLY_ARRAY) {
+        for (size_t i = 0; i < r->element[3]->elements; ++i) {
+            const redisReply *item = r->element[3]->element[i];
+            if (item->type != REDIS_REPLY_ARRAY || item->elements != 2) {
+                continue;
+            }
+            summary.consumers.push_back(std::make_pair(
+                        std::string(item->element[0]->str, item->element[0]->len),
+                        strtoll(item->element[1]->str, nullptr, 10)));
+        }
     }
 
-    return reply->integer;
+    return static_cast<int>(summary.count);
 }
 
-int ttl(std::string const &key, int &result)
+int PRedisClient::xpending(PStringRef key, PStringRef group,
+        PStringRef start, PStringRef end, size_t count,
+        uint64_t min_idle_ms, std::vector<PRedisStreamPendingEntry> &entries)
 {
-    if (!is_init_ok()) { return -1; }
-
-    reply = redisCommand("TTL %s", key.c_str());
-    if (nullptr == reply) {
-        pc_log_error("TTL %s error: reply is nullptr", key.c_str());
-        return -1;
+    PRespWriter writer = begin_command(min_idle_ms > 0 ? 8 : 6);
+    writer.arg("XPENDING", 8).arg(key).arg(group);
+    if (min_idle_ms > 0) {
+        writer.arg("IDLE", 4).arg(static_cast<long long>(min_idle_ms));
     }
-    if (reply->type == REDIS_REPLY_ERROR) {
-        pc_log_error("TTL %s error", key.c_str());
+    writer.arg(start).arg(end).arg(static_cast<long long>(count));
+
+    redisReply *r = exec_command("XPENDING", key, REDIS_REPLY_ARRAY);
+    if (nullptr == r || r->type != REDIS_REPLY_ARRAY) {
         return -1;
     }
-    if (reply->type != REDIS_REPLY_INTEGER) {
-        pc_log_error("TTL %s error: type is not REDIS_REPLY_INTEGER", key.c_str());
-        return -1;
+
+    entries.resize(r->elements);
+    for (size_t i = 0; i < r->elements; ++i) {
+        const redisReply *item = r->element[i];
+        if (item->type != REDIS_REPLY_ARRAY || item->elements != 4) {
+            report_error("XPENDING", key, PREDIS_ERR_TYPE, "malformed entry");
+            return -1;
+        }
+        entries[i].id.assign(item->element[0]->str, item->element[0]->len);
+        entries[i].consumer.assign(item->element[1]->str, item->element[1]->len);
+        entries[i].idle_ms    = item->element[2]->integer;
+        entries[i].deliveries = item->element[3]->integer;
     }
-    result = reply->integer;
 
-    return 0;
+    return static_cast<int>(entries.size());
 }
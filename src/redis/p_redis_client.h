@@ -6,17 +6,181 @@
 
 #pragma once
 
-#include "nocopyable.h"
+#include "non_copyable.h"
 #include "hiredis.h"
+#include "p_redis_admission.h"
+#include "p_redis_alloc.h"
+#include "p_redis_call_site.h"
+#include "p_redis_codec.h"
+#include "p_redis_compressor.h"
+#include "p_redis_deadline.h"
+#include "p_redis_error.h"
+#include "p_redis_hash_mapping.h"
+#include "p_redis_health.h"
+#include "p_redis_metrics.h"
+#include "p_redis_phase.h"
+#include "p_redis_probe.h"
+#include "p_redis_reply.h"
+#include "p_redis_resp.h"
+#include "p_redis_retry.h"
+#include "p_redis_sentinel.h"
+#include "p_redis_slowlog.h"
+#include "p_redis_stream.h"
+#include "p_redis_string_list.h"
+#include "p_string_ref.h"
 
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
 #include <utility>
 
 namespace pepper
 {
 
-    class PRedisClient : public nocopyable
+    /*
+     * 字符串参数均为 PStringRef, 可以直接传入 std::string, const char *,
+     * string_view 或 (指针, 长度); 多个参数的命令另有迭代器区间版本,
+     * 元素可以是上述任意类型, 例如 std::vector<PStringRef> 或 PStringRef 数组.
+     * 参数直接编码为 RESP 写入复用的命令缓冲区, 不会构造临时 std::string.
+     *
+     * 返回多个元素的命令另有 PBasicRedisStringList 版本, 结果追加到一块
+     * 连续内存, 不再每个元素分配一个 std::string; 可以传入
+     * PRedisStringList 或使用调用者内存池的 pmr::PRedisStringList.
+     *
+     * get/set/hget/hset 另有模板版本, 值按 PRedisCodec<T> 直接编码进命令
+     * 缓冲区、从回复内存解码, 见 p_redis_codec.h.
+     * 用 PEPPER_REDIS_HASH 声明过的结构体可以整体 hset/hmget,
+     * 见 p_redis_hash_mapping.h.
+     *
+     * enable_compression 后字符串和 hash 的值透明压缩: 写值的命令 (set/setnx/setex/
+     * mset/hset/hsetnx/hmset, 包括模板和结构体版本) 压缩, 读值的命令 (get/mget/
+     * hget/hmget/hgetall/hvals) 还原; key, field 和其他类型的元素不压缩.
+     * 格式见 p_redis_compressor.h.
+     *
+     * 返回 -1 时 last_error() 给出错误类型; 错误和 NIL 回复按命令计数,
+     * NIL 不输出日志, 错误日志按秒限流.
+     *
+     * set_retry_policy 后幂等命令在 IO 错误时自动重连并退避重试;
+     * 多副本的对冲读见 p_redis_hedged_reader.h.
+     *
+     * enable_metrics 后按 (命令, 节点) 记录延迟直方图、字节数和错误数,
+     * 由 PRedisMetricsRegistry 汇总导出, 见 p_redis_metrics.h.
+     * enable_call_sites 后按 PRedisCallSiteScope 标记的调用点统计.
+     */
+    class PRedisClient : public noncopyable
     {
         public:
+            ~PRedisClient();
+
+            /*
+             * @brief 开启字符串和 hash 值的压缩, 覆盖的命令见类说明
+             * return 0 成功  -1 字典无效
+             */
+            int enable_compression(const PRedisCompressionOptions &options);
+
+            /* 没有开启压缩时返回 nullptr */
+            const PRedisCompressionStats *compression_stats() const;
+
+            /* 最近一条命令的错误, 成功或 NIL 为 PREDIS_OK */
+            PRedisError last_error() const;
+
+            /* 最近一次错误的服务端错误信息或 IO 错误描述 */
+            const std::string &last_error_message() const;
+
+            const std::vector<PRedisCommandCounters> &command_counters() const;
+
+            /* 每秒最多输出的错误日志条数, 默认 10, 0 不输出 */
+            void set_error_log_limit(uint32_t limit_per_second);
+
+            /*
+             * @brief IO 错误后的重试: 重新连接, 等待带抖动的退避时间后重发.
+             * 默认策略只用于幂等命令, 其他命令需要单独指定, 见 p_redis_retry.h.
+             * 默认不重试
+             */
+            void set_retry_policy(const PRedisRetryPolicy &policy);
+            void set_retry_policy(const char *cmd, const PRedisRetryPolicy &policy);
+
+            /*
+             * @brief 之后的命令使用的截止时间和取消标记, 一般用 PRedisDeadlineScope 设置.
+             * 超时或取消时命令返回 -1, last_error() 为 PREDIS_ERR_TIMEOUT/CANCELLED,
+             * 迟到的回复在之后的命令中丢弃; 积压过多时重新连接.
+             * 设置了取消标记时每 5ms 检查一次
+             */
+            void set_deadline(const PRedisDeadline &deadline);
+            const PRedisDeadline &deadline() const;
+
+            /*
+             * 没有显式截止时间或推算的更早时, 按该命令最近的延迟分位数限时;
+             * 阻塞命令 (XREADGROUP BLOCK) 在阻塞时间之上再加该限时, 一直阻塞时不限时
+             */
+            void set_adaptive_deadline(const PRedisAdaptiveDeadlineOptions &options);
+
+            /*
+             * @brief 连到同一节点的客户端共享一个 PRedisAdmission, 熔断打开或超过
+             * 并发上限时命令不发送, 立即返回 -1, last_error() 为
+             * PREDIS_ERR_CIRCUIT_OPEN/PREDIS_ERR_OVERLOADED
+             */
+            void set_admission(const std::shared_ptr<PRedisAdmission> &admission);
+
+            /*
+             * @brief 连接出错后按退避时间重连, 未到时间或重连令牌不足时命令立即失败,
+             * last_error() 为 PREDIS_ERR_NOT_CONNECTED. 默认只有 health_check() 重连,
+             * 需要由定时器周期调用; 打开 lazy_reconnect 后命令调用也会重连.
+             * 重试策略中的重连同样受退避和重连令牌限制.
+             */
+            void set_health_options(const PRedisHealthOptions &options);
+
+            /* 连到同一节点的客户端共享, 限制重连频率 */
+            void set_reconnect_budget(const std::shared_ptr<PRedisReconnectBudget> &budget);
+
+            /*
+             * @brief 连接出错时尝试重连, 空闲过久时发 PING
+             * return 1 连接可用  0 不可用(等待下次重连)
+             */
+            int health_check();
+
+            /* 连续重连失败的次数 */
+            uint32_t reconnect_failures() const;
+
+            /*
+             * @brief 跟随 endpoint 的地址 (一般来自 PRedisSentinel), 地址变化后
+             * 下一条命令前切换到新节点
+             */
+            void set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /*
+             * @brief 开启命令指标, 登记到 PRedisMetricsRegistry::instance();
+             * 客户端析构后其计数并入 registry, 不会丢失
+             */
+            void enable_metrics();
+
+            /*
+             * @brief 每 every_n 条命令采样一条, 按命令统计各阶段 (编码、写、等待、
+             * 解析、复制) 的耗时, 见 p_redis_phase.h. 0 关闭 (默认)
+             */
+            void set_phase_sampling(uint32_t every_n);
+            const std::vector<PRedisPhaseCounters> &phase_counters() const;
+
+            /* 开启调用点统计, 调用点用 PRedisCallSiteScope 标记 */
+            void enable_call_sites();
+
+            /* 没有开启时返回 nullptr */
+            const PRedisCallSiteStats *call_site_stats() const;
+
+            /* 按总耗时取前 top_n 个调用点的文本报告, 没有开启时为空 */
+            std::string call_site_report(size_t top_n) const;
+
+            /* 由 PRedisCallSiteScope 调用, 返回之前的调用点 */
+            PRedisCallSiteCounters *enter_call_site(const PRedisCallSite &site);
+            void leave_call_site(PRedisCallSiteCounters *saved);
+
+            /*
+             * @brief 超过阈值的命令记入 slowlog, 包括截断的参数、各阶段耗时和连接;
+             * 多个客户端可以共享一个. 开启后每条命令多读几次 tsc
+             */
+            void set_slowlog(const std::shared_ptr<PRedisSlowlog> &slowlog);
+
              /*
              * redis命令 2.6.12以上的版本支持
              * SET key value [EX seconds] [PX milliseconds] [NX|XX]
@@ -24,54 +188,75 @@ namespace pepper
              *        0 失败
              *        -1 异常
              */
-            int set(const std::string &key, const std::string &value);
+            int set(PStringRef key, PStringRef value);
    
             /*
              * return 设置成功返回1
              *        设置失败返回0
              *        异常 返回 -1
              */
-            int setnx(const std::string &key, const std::string &value);
+            int setnx(PStringRef key, PStringRef value);
     
             /*
              * 设置成功返回 1
              * 异常返回 -1
              */
-            int setex(const std::string &key, uint32_t seconds,
-                      const std::string &value);
+            int setex(PStringRef key, uint32_t seconds,
+                      PStringRef value);
     
             /*
              * return incr 后的值
              * */
-            long long incr(const std::string &key);
+            long long incr(PStringRef key);
             
             /*
              * return 1 成功 
              *        -1 异常
              */
             int mset(const std::vector<std::pair<std::string, std::string> > &fields);
+
+            /* 元素为 pair<key, value> */
+            template <typename Iter>
+            int mset(Iter first, Iter last);
     
             /*
              * return >0 返回的结果数
              *        -1 异常
              */
             int mget(const std::vector<std::string> &keys, std::vector<std::string> &values);
+
+            template <typename Iter>
+            int mget(Iter first, Iter last, std::vector<std::string> &values);
     
             /*
              * return 1 成功
              *        0 没有数据
              *       -1 异常
              */
-            int get(const std::string &key, std::string &value);
+            int get(PStringRef key, std::string &value);
+
+            /*
+             * @brief 按 PRedisCodec<T> 编解码的 SET/GET
+             * set 返回值同 set(key, value)
+             * get return 1 成功  0 没有数据  -1 异常或解码失败
+             */
+            template <typename T>
+            PRedisCodecResult<T> set(PStringRef key, const T &value);
+
+            template <typename T>
+            PRedisCodecResult<T> get(PStringRef key, T &value);
     
             /*
              * return 1 删除成功
              *        0 key不存在
              *       -1 异常
              */
-            int del(const std::string &key);
+            int del(PStringRef key);
             int del(const std::vector<std::string> &keys);
 
+            template <typename Iter>
+            int del(Iter first, Iter last);
+
             long int dbsize();
     
             /*
@@ -79,13 +264,16 @@ namespace pepper
              *        0 key不存在
              *       -1 异常
              */
-            int expire(const std::string &key, uint32_t secs);
+            int expire(PStringRef key, uint32_t secs);
     
             /*
              * @brief 查找所有符合给定模式 pattern 的 key
              * @return -1 错误 >=0 key的数量
              */
-            int keys(const std::string &pattern, std::vector<std::string> &out);
+            int keys(PStringRef pattern, std::vector<std::string> &out);
+
+            template <typename Chars, typename Offsets>
+            int keys(PStringRef pattern, PBasicRedisStringList<Chars, Offsets> &out);
     
             /*
              * @brief exists
@@ -93,16 +281,19 @@ namespace pepper
              *         1 存在
              *        -1 redis异常
              */
-            int exists(const std::string &key);
-            int sadd(const std::string &key, const std::string &value);
-            int sadd(const std::string &key, const std::vector<std::string> &value);
+            int exists(PStringRef key);
+            int sadd(PStringRef key, PStringRef value);
+            int sadd(PStringRef key, const std::vector<std::string> &value);
+
+            template <typename Iter>
+            int sadd(PStringRef key, Iter first, Iter last);
     
             /*
              * return 1 成功删除
              *        0 key不存在
              *       -1 异常
              */
-            int srem(const std::string &key, const std::string &value);
+            int srem(PStringRef key, PStringRef value);
     
             /*
              * @brief 判断 member 元素是否集合 key 的成员
@@ -110,18 +301,32 @@ namespace pepper
              * 不是集合的元素返回 0
              * 错误返回 -1
              */
-            int sismember(const std::string &key, const std::string &value);
+            int sismember(PStringRef key, PStringRef value);
     
-            int smembers(std::string const &key, std::vector<std::string> &values);
+            int smembers(PStringRef key, std::vector<std::string> &values);
+
+            template <typename Chars, typename Offsets>
+            int smembers(PStringRef key, PBasicRedisStringList<Chars, Offsets> &values);
     
-            int spop(const std::string &key, std::string &value);
+            int spop(PStringRef key, std::string &value);
     
             /*
              * @brief 
              * 成功返回0或1   1表示新增key, 0表示覆盖旧值.
              * 失败返回 -1
              */
-            int hset(const std::string &key, const std::string &field, const std::string &value);
+            int hset(PStringRef key, PStringRef field, PStringRef value);
+
+            template <typename T>
+            PRedisCodecResult<T> hset(PStringRef key, PStringRef field, const T &value);
+
+            /*
+             * @brief HSET key 把 PEPPER_REDIS_HASH 声明的所有成员写入 hash (redis 4.0+)
+             * return 新增的 field 个数
+             *       -1 异常
+             */
+            template <typename T>
+            PRedisHashResult<T> hset(PStringRef key, const T &obj);
     
             /*
              * @brief 
@@ -129,106 +334,247 @@ namespace pepper
              * 失败返回 0
              * 异常返回 -1
              */
-            int hsetnx(const std::string &key, const std::string &field, const std::string &value);
+            int hsetnx(PStringRef key, PStringRef field, PStringRef value);
     
             /*
              * @brief 成功返回 1
              * 失败返回 -1
              */
-            int hmset(const std::string &key, const std::vector< std::pair<std::string, std::string> > &field_value_pairs);
+            int hmset(PStringRef key, const std::vector< std::pair<std::string, std::string> > &field_value_pairs);
+
+            /* 元素为 pair<field, value> */
+            template <typename Iter>
+            int hmset(PStringRef key, Iter first, Iter last);
     
-            int hmget(std::string const &key, const std::vector<std::string> &fields, std::vector<std::string> &values);
+            int hmget(PStringRef key, const std::vector<std::string> &fields, std::vector<std::string> &values);
+
+            template <typename Iter>
+            int hmget(PStringRef key, Iter first, Iter last, std::vector<std::string> &values);
+
+            /*
+             * @brief HMGET key 读取 PEPPER_REDIS_HASH 声明的所有成员,
+             * 不存在的 field 对应的成员保持原值
+             * return 读到的 field 个数, key 不存在返回 0
+             *       -1 异常或解码失败
+             */
+            template <typename T>
+            PRedisHashResult<T> hmget(PStringRef key, T &obj);
+
             /*
-             * @brief 成功返回 0 
+             * @brief 成功返回 1
+             * field 不存在返回 0
              * 失败返回 -1
              */
-            int hget(const std::string &key, const std::string &field, std::string &value);
+            int hget(PStringRef key, PStringRef field, std::string &value);
+
+            /* return 1 成功  0 field 不存在  -1 异常或解码失败 */
+            template <typename T>
+            PRedisCodecResult<T> hget(PStringRef key, PStringRef field, T &value);
     
             /*
              * @brief 成功返回key的个数 >=0
              * 失败返回 -1
              */
-            int hgetall(const std::string &key, std::vector< std::pair<std::string, std::string> > &field_value_pairs);
+            int hgetall(PStringRef key, std::vector< std::pair<std::string, std::string> > &field_value_pairs);
+
+            /* field, value 交替存放, 返回 field 的个数 */
+            template <typename Chars, typename Offsets>
+            int hgetall(PStringRef key, PBasicRedisStringList<Chars, Offsets> &field_values);
     
             /*
              * @brief key 存在返回 1 不存在返回0
              * 失败返回 -1
              */
-            int hexists(const std::string &key, const std::string &field);
+            int hexists(PStringRef key, PStringRef field);
     
             /*
              * @brief 成功删除 返回1 删除不存在的key 返回0 
              * 失败返回 -1
              */
-            int hdel(const std::string &key, const std::string &field);
-            int hdel(const std::string &key, const std::vector<std::string> &fields);
+            int hdel(PStringRef key, PStringRef field);
+            int hdel(PStringRef key, const std::vector<std::string> &fields);
+
+            template <typename Iter>
+            int hdel(PStringRef key, Iter first, Iter last);
     
             /*
              * @brief 成功返回key的个数
              * 失败返回 -1
              */
-            int hkeys(const std::string &key, std::vector<std::string> &out);
+            int hkeys(PStringRef key, std::vector<std::string> &out);
+
+            template <typename Chars, typename Offsets>
+            int hkeys(PStringRef key, PBasicRedisStringList<Chars, Offsets> &out);
     
             /*
              * @brief 成功返回哈希表 key 中所有域的值的个数
              * 失败返回 -1
              */
-            int hvals(const std::string &key, std::vector<std::string> &out);
+            int hvals(PStringRef key, std::vector<std::string> &out);
+
+            template <typename Chars, typename Offsets>
+            int hvals(PStringRef key, PBasicRedisStringList<Chars, Offsets> &out);
     
             /*
              *@brief 返回哈希表 key 中域的数量。
              * 失败返回 -1
              */
-            int hlen(const std::string &key);
+            int hlen(PStringRef key);
     
             /*
              * @brief 在key-filed对应原值的基础上增加value
              * @param res 在命令成功的前提下，返回命令执行结果
              * @return -1 on failed, 1 on success
              */
-            int hincrby(const std::string &key, const std::string &field, 
-                    const std::string &value, long long &res);
+            int hincrby(PStringRef key, PStringRef field, 
+                    PStringRef value, long long &res);
     
             /*
              * @brief lpush
              * return 列表的长度 失败返回 -1
              */
-            int lpush(std::string const &key, const std::vector<std::string> &values);
-            int lpush(std::string const &key, std::string const &value);
+            int lpush(PStringRef key, const std::vector<std::string> &values);
+            int lpush(PStringRef key, PStringRef value);
+
+            template <typename Iter>
+            int lpush(PStringRef key, Iter first, Iter last);
     
-            int lpushx(std::string const &key, std::string const &value);
-            int rpush(std::string const &key, const std::vector<std::string> &values);
-            int rpush(std::string const &key, std::string const &value);
-            int llen(std::string const &key);
-            int lrange(std::string const &key, int start, int stop,
+            int lpushx(PStringRef key, PStringRef value);
+            int rpush(PStringRef key, const std::vector<std::string> &values);
+            int rpush(PStringRef key, PStringRef value);
+
+            template <typename Iter>
+            int rpush(PStringRef key, Iter first, Iter last);
+
+            int llen(PStringRef key);
+            int lrange(PStringRef key, int start, int stop,
                     std::vector<std::string> &values);
+
+            template <typename Chars, typename Offsets>
+            int lrange(PStringRef key, int start, int stop,
+                    PBasicRedisStringList<Chars, Offsets> &values);
     
             /*
              * @brief 
              * return 成功返回1  失败返回0
              */
-            int lpop(std::string const &key, std::string &value);
-            int rpop(std::string const &key, std::string &value);
-            int ltrim(std::string const &key, int start, int stop);
+            int lpop(PStringRef key, std::string &value);
+            int rpop(PStringRef key, std::string &value);
+
+            /*
+             * @brief LPOP/RPOP key count, 一次往返弹出多个元素 (redis 6.2+)
+             * return 弹出的元素个数, 列表为空返回0
+             *        -1 异常
+             */
+            int lpop(PStringRef key, size_t count, std::vector<std::string> &values);
+            int rpop(PStringRef key, size_t count, std::vector<std::string> &values);
+
+            /*
+             * @brief LMOVE source destination wherefrom whereto (redis 6.2+)
+             * wherefrom/whereto 取值 "LEFT" 或 "RIGHT"
+             * return 1 成功
+             *        0 source 为空
+             *       -1 异常
+             */
+            int lmove(PStringRef source, PStringRef destination,
+                    PStringRef wherefrom, PStringRef whereto,
+                    std::string &value);
+            int ltrim(PStringRef key, int start, int stop);
     
-            int zadd(std::string const &key, int64_t score, std::string const &member);
-            int zadd(std::string const &key,const std::vector<std::pair<int64_t, std::string> > &member_score_pair_v);
-            int zrem(std::string const &key, std::string const &member);
-            int zrem(std::string const &key, std::vector<std::string> const &members);
-            int zcard(std::string const &key);
+            int zadd(PStringRef key, int64_t score, PStringRef member);
+            int zadd(PStringRef key,const std::vector<std::pair<int64_t, std::string> > &member_score_pair_v);
+
+            /* 元素为 pair<score, member>, score 为整数 */
+            template <typename Iter>
+            int zadd(PStringRef key, Iter first, Iter last);
+
+            int zrem(PStringRef key, PStringRef member);
+            int zrem(PStringRef key, std::vector<std::string> const &members);
+
+            template <typename Iter>
+            int zrem(PStringRef key, Iter first, Iter last);
+
+            int zcard(PStringRef key);
     
-            int zscore(const std::string &key, const std::string &member, std::string &score);
+            int zscore(PStringRef key, PStringRef member, std::string &score);
     
             /*
              * @brief 
-             * return 成功返回元素数量  失败返回0
+             * return 成功返回元素数量  失败返回-1
              */
-            int zrangebyscore(std::string const &key, std::string const &min_score,
-                    std::string const &max_score,
+            int zrangebyscore(PStringRef key, PStringRef min_score,
+                    PStringRef max_score,
                     std::vector<std::string> &members);
     
-            int zremrangebyscore(std::string const &key,
-                    std::string const &min_score, std::string const &max_score);
+            int zremrangebyscore(PStringRef key,
+                    PStringRef min_score, PStringRef max_score);
+
+            /*
+             * @brief XADD key [MAXLEN ~ maxlen] * field value [field value ...]
+             * @param maxlen 0 不裁剪, >0 使用 MAXLEN ~ 近似裁剪(按宏节点裁剪, 开销很小)
+             * @param id     成功时返回服务端生成的消息ID
+             * return 1 成功
+             *       -1 异常
+             */
+            int xadd(PStringRef key,
+                    const std::vector< std::pair<std::string, std::string> > &fields,
+                    std::string &id, size_t maxlen = 0);
+
+            /* 元素为 pair<field, value> */
+            template <typename Iter>
+            int xadd(PStringRef key, Iter first, Iter last,
+                    std::string &id, size_t maxlen = 0);
+
+            /*
+             * @brief XREADGROUP GROUP group consumer COUNT count [BLOCK ms] STREAMS key id
+             * BLOCK 会占住当前连接, 消费者请优先使用 PRedisStreamConsumer
+             * @param block_ms <0 不阻塞, 0 一直阻塞, >0 最多阻塞的毫秒数
+             * return >=0 读到的消息数(超时返回0)
+             *         -1 异常
+             */
+            int xreadgroup(PStringRef group, PStringRef consumer,
+                    PStringRef key, PStringRef id, size_t count,
+                    int block_ms, std::vector<PRedisStreamEntry> &entries);
+
+            /*
+             * @brief 一条 XACK 命令确认多条消息
+             * return >=0 确认成功的条数
+             *         -1 异常
+             */
+            int xack(PStringRef key, PStringRef group,
+                    const std::vector<std::string> &ids);
+
+            template <typename Iter>
+            int xack(PStringRef key, PStringRef group, Iter first, Iter last);
+
+            /*
+             * @brief XAUTOCLAIM key group consumer min-idle-time start COUNT count
+             * @param next_start 返回下一次扫描的起始ID, "0-0" 表示已扫描完整个 PEL
+             * return >=0 接管的消息数
+             *         -1 异常
+             */
+            int xautoclaim(PStringRef key, PStringRef group,
+                    PStringRef consumer, uint64_t min_idle_ms,
+                    PStringRef start, size_t count, std::string &next_start,
+                    std::vector<PRedisStreamEntry> &entries);
+
+            /*
+             * @brief XPENDING key group
+             * return >=0 待确认的消息总数
+             *         -1 异常
+             */
+            int xpending(PStringRef key, PStringRef group,
+                    PRedisStreamPendingSummary &summary);
+
+            /*
+             * @brief XPENDING key group [IDLE min_idle_ms] start end count
+             * @param min_idle_ms 0 表示不按空闲时间过滤
+             * return >=0 返回的条数
+             *         -1 异常
+             */
+            int xpending(PStringRef key, PStringRef group,
+                    PStringRef start, PStringRef end, size_t count,
+                    uint64_t min_idle_ms, std::vector<PRedisStreamPendingEntry> &entries);
     
     
             /*
@@ -240,7 +586,7 @@ namespace pepper
              * @brief 查询key的过期时间
              * @return 0 On success, -1 on error
              */
-            int ttl(std::string const &key, int &result = s_ignore_ref_params);
+            int ttl(PStringRef key, int &result = s_ignore_ref_params);
     
         private:
             // TODO friend
@@ -248,8 +594,592 @@ namespace pepper
 
             bool is_init_ok();
 
-            redisContext *redis_context_;
-            redisReply *reply;
+            int pop_count(const char *cmd, PStringRef key, size_t count,
+                    std::vector<std::string> &values);
+
+            /*
+             * @brief 清空命令缓冲区并写入参数个数, 之后依次 arg() 写入各参数
+             */
+            PRespWriter begin_command(size_t argc);
+
+            /* 同上, 以预先编码好的 RESP 前缀 (参数个数和开头的参数) 开始 */
+            PRespWriter begin_command(const std::string &prefix);
+
+            /*
+             * @brief 发送 begin_command 编码好的命令并读取回复
+             * 上一条命令的回复在这里释放, 返回的回复归 PRedisClient 所有
+             * @param cmd, key 只用于日志
+             * return 类型为 expect_type 或 NIL 的回复, 其他情况返回 nullptr
+             */
+            redisReply *exec_command(const char *cmd, PStringRef key, int expect_type);
+
+            /* exec_command 的执行部分, 开启指标时由 exec_command 计时和计数 */
+            redisReply *run_command(const char *cmd, PStringRef key, int expect_type);
+
+            /* 当前连接节点的指标条目, 地址变化后重新查找 */
+            PRedisMetrics::Endpoint *metrics_endpoint();
+
+            void record_slow(uint64_t elapsed_us, uint64_t received);
+
+            /* return 0 成功 -1 异常 */
+            int exec_integer(const char *cmd, PStringRef key, long long &value);
+
+            /* 整数回复转为 int 返回, -1 异常 */
+            int exec_count(const char *cmd, PStringRef key);
+
+            /* return 1 回复 OK  0 其他状态  -1 异常 */
+            int exec_status(const char *cmd, PStringRef key);
+
+            /* return 1 成功  0 NIL  -1 异常 */
+            int exec_string(const char *cmd, PStringRef key, std::string &value);
+
+            /* 元素追加到 values, NIL 元素为空串; return 元素个数, -1 异常 */
+            int exec_strings(const char *cmd, PStringRef key, std::vector<std::string> &values);
+
+            /* round_trip, IO 错误时按重试策略重连重发 */
+            PRedisError retry_round_trip(const char *cmd, uint64_t deadline_us,
+                                         PRedisCommandCounters &counters);
+
+            /*
+             * @brief 发送 cmd_buf_ 并等待回复到 reply_, 先丢弃之前超时命令的回复
+             * return PREDIS_OK / PREDIS_ERR_IO / PREDIS_ERR_TIMEOUT / PREDIS_ERR_CANCELLED
+             */
+            PRedisError round_trip(uint64_t deadline_us, const PRedisCancelToken *cancel);
+
+            /* 带截止时间和取消检查的读取, 返回值同 round_trip */
+            PRedisError wait_reply(uint64_t deadline_us, const PRedisCancelToken *cancel, void **reply);
+
+            void reconnect();
+
+            /* 到期且拿到令牌时重连, return true 重连成功 */
+            bool try_reconnect();
+
+            void follow_endpoint();
+
+            /* 记录错误码并计数, 按限流输出日志, 返回 -1 */
+            int report_error(const char *cmd, PStringRef key, PRedisError error,
+                             const char *message);
+
+            /* 发送前失败: report_error, 并计入 admission 的失败率 */
+            void fail_before_send(const char *cmd, PStringRef key, PRedisError error,
+                                  const char *message);
+
+            /* 写入一个值参数, 开启压缩时按压缩格式写 */
+            void append_value(PRespWriter &writer, PStringRef value);
+            void log_compress_error();
+
+            /* 还原存储的值, return 0 成功 -1 数据损坏 */
+            int read_value(PStringRef stored, PStringRef &value);
+
+            /* return 1 成功  0 NIL  -1 异常或解压失败 */
+            int exec_value(const char *cmd, PStringRef key, std::string &value);
+
+            /* 数组回复的值逐个还原后追加到 values, return 元素个数 -1 异常或解压失败 */
+            int exec_values(const char *cmd, PStringRef key, std::vector<std::string> &values);
+
+            template <typename List>
+            int exec_value_list(const char *cmd, PStringRef key, List &values)
+            {
+                if (!compressor_) {
+                    return exec_list(cmd, key, values);
+                }
+
+                redisReply *r = exec_command(cmd, key, REDIS_REPLY_ARRAY);
+                if (nullptr == r) {
+                    return -1;
+                }
+                if (r->type == REDIS_REPLY_NIL) {
+                    return 0;
+                }
+
+                for (size_t i = 0; i < r->elements; ++i) {
+                    PStringRef data;
+                    if (0 != read_element(r->element[i], data)) {
+                        return report_error(cmd, key, PREDIS_ERR_DECODE, compressor_->error());
+                    }
+                    values.push_back(data);
+                }
+                phase_timer_.decoded();
+
+                return static_cast<int>(r->elements);
+            }
+
+            /* 数组回复的一个元素, 非字符串为空串; return 0 成功 -1 解压失败 */
+            int read_element(const redisReply *item, PStringRef &value)
+            {
+                if (item->type != REDIS_REPLY_STRING) {
+                    value = PStringRef();
+                    return 0;
+                }
+
+                return read_value(PStringRef(item->str, item->len), value);
+            }
+
+            template <typename T>
+            void encode_value(PRespWriter &writer, const T &value)
+            {
+                size_t len = PRedisCodec<T>::size(value);
+                if (compressor_) {
+                    value_buf_.resize(len);
+                    PRedisCodec<T>::encode(value, &value_buf_[0]);
+                    if (0 != compressor_->write_arg(writer, value_buf_)) {
+                        log_compress_error();
+                    }
+                    return;
+                }
+                PRedisCodec<T>::encode(value, writer.arg_space(len));
+            }
+
+            /* return 1 成功  0 NIL  -1 异常或解码失败 */
+            template <typename T>
+            int exec_decode(const char *cmd, PStringRef key, T &value)
+            {
+                redisReply *r = exec_command(cmd, key, REDIS_REPLY_STRING);
+                if (nullptr == r) {
+                    return -1;
+                }
+                if (r->type == REDIS_REPLY_NIL) {
+                    return 0;
+                }
+
+                PStringRef data;
+                if (0 != read_value(PStringRef(r->str, r->len), data)) {
+                    return report_error(cmd, key, PREDIS_ERR_DECODE, compressor_->error());
+                }
+                if (!PRedisCodec<T>::decode(data.data(), data.size(), value)) {
+                    return report_error(cmd, key, PREDIS_ERR_DECODE, "cannot decode value");
+                }
+                phase_timer_.decoded();
+
+                return 1;
+            }
+
+            /* 元素追加到 values, return 元素个数, -1 异常 */
+            template <typename List>
+            int exec_list(const char *cmd, PStringRef key, List &values)
+            {
+                redisReply *r = exec_command(cmd, key, REDIS_REPLY_ARRAY);
+                if (nullptr == r) {
+                    return -1;
+                }
+                if (r->type == REDIS_REPLY_NIL) {
+                    return 0;
+                }
+
+                size_t n = values.append(r);
+                phase_timer_.decoded();
+
+                return static_cast<int>(n);
+            }
+
+            template <typename Iter>
+            static void append_args(PRespWriter &writer, Iter first, Iter last)
+            {
+                for (; first != last; ++first) {
+                    writer.arg(PStringRef(*first));
+                }
+            }
+
+            template <typename Iter>
+            static void append_pairs(PRespWriter &writer, Iter first, Iter last)
+            {
+                for (; first != last; ++first) {
+                    writer.arg(first->first);
+                    writer.arg(PStringRef(first->second));
+                }
+            }
+
+            /* pair 的 second 是值, 开启压缩时按压缩格式写 */
+            template <typename Iter>
+            void append_value_pairs(PRespWriter &writer, Iter first, Iter last)
+            {
+                for (; first != last; ++first) {
+                    writer.arg(first->first);
+                    append_value(writer, PStringRef(first->second));
+                }
+            }
+
+            static int s_ignore_ref_params;
+
+            redisContext   *redis_context_ = nullptr;
+            PRedisReplyPool reply_pool_;
+            PRedisReply     reply_;         /* 最近一条命令的回复, 下一条命令前回收 */
+            std::string     cmd_buf_;
+
+            std::unique_ptr<PRedisCompressor> compressor_;
+            std::string value_buf_;
+
+            PRedisError        last_error_ = PREDIS_OK;
+            std::string        last_error_message_;
+            PRedisCommandStats command_stats_;
+            PRedisErrorLog     error_log_;
+
+            PRedisRetryPolicies retry_policies_;
+            PRedisBackoff       backoff_;
+
+            PRedisDeadline                          deadline_;
+            std::unique_ptr<PRedisAdaptiveDeadline> adaptive_deadline_;
+            uint32_t                                stale_replies_ = 0;     /* 待丢弃的迟到回复 */
+            int                                     block_ms_ = -1;         /* 阻塞命令的阻塞时间, 非阻塞命令为 -1 */
+
+            std::shared_ptr<PRedisAdmission>        admission_;
+
+            PRedisHealthOptions                     health_options_;
+            PRedisReconnectSchedule                 reconnect_schedule_;
+            std::shared_ptr<PRedisReconnectBudget>  reconnect_budget_;
+            uint64_t                                last_used_us_ = 0;
+
+            std::shared_ptr<PRedisEndpoint>         endpoint_;
+            uint64_t                                endpoint_generation_ = 0;
+
+            std::unique_ptr<PRedisMetrics>          metrics_;
+            PRedisMetrics::Endpoint                *metrics_endpoint_ = nullptr;
+
+            PRedisPhaseTimer                        phase_timer_;
+
+            std::unique_ptr<PRedisCallSiteStats>    call_sites_;
+            PRedisCallSiteCounters                 *call_site_ = nullptr;
+
+            std::shared_ptr<PRedisSlowlog>          slowlog_;
     };
 
+    /*
+     * @brief 作用域内的命令使用 deadline, 析构时恢复;
+     * 嵌套时取较早的截止时间, 没有给出取消标记时沿用外层的
+     */
+    class PRedisDeadlineScope : public noncopyable
+    {
+        public:
+            PRedisDeadlineScope(PRedisClient &client, const PRedisDeadline &deadline)
+                : client_(client), saved_(client.deadline())
+            {
+                PRedisDeadline inner = deadline;
+                if (saved_.at_us != 0 && (0 == inner.at_us || saved_.at_us < inner.at_us)) {
+                    inner.at_us = saved_.at_us;
+                }
+                if (nullptr == inner.cancel) {
+                    inner.cancel = saved_.cancel;
+                }
+                client_.set_deadline(inner);
+            }
+
+            ~PRedisDeadlineScope()
+            {
+                client_.set_deadline(saved_);
+            }
+
+        private:
+            PRedisClient  &client_;
+            PRedisDeadline saved_;
+    };
+
+    /*
+     * @brief 作用域内的命令计入一个调用点, 析构时恢复外层的调用点.
+     * 不给出 file/line 时取构造处的位置, 例:
+     *     PRedisCallSiteScope site(client, "load_user");
+     * 没有开启调用点统计时只保存一个指针
+     */
+    class PRedisCallSiteScope : public noncopyable
+    {
+        public:
+            explicit PRedisCallSiteScope(PRedisClient &client, const char *label = nullptr,
+                                         const char *file = __builtin_FILE(),
+                                         int line = __builtin_LINE())
+                : client_(client)
+            {
+                PRedisCallSite site = { label, file, line };
+                saved_ = client_.enter_call_site(site);
+            }
+
+            ~PRedisCallSiteScope()
+            {
+                client_.leave_call_site(saved_);
+            }
+
+        private:
+            PRedisClient           &client_;
+            PRedisCallSiteCounters *saved_;
+    };
+
+    /*
+     * 迭代器区间版本要求前向迭代器, 先用 std::distance 求出参数个数
+     */
+    template <typename Iter>
+    int PRedisClient::mset(Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(1 + 2 * std::distance(first, last));
+        writer.arg("MSET", 4);
+        append_value_pairs(writer, first, last);
+        return exec_status("MSET", PStringRef());
+    }
+
+    template <typename T>
+    PRedisCodecResult<T> PRedisClient::set(PStringRef key, const T &value)
+    {
+        PRespWriter writer = begin_command(3);
+        writer.arg("SET", 3).arg(key);
+        encode_value(writer, value);
+        return exec_status("SET", key);
+    }
+
+    template <typename T>
+    PRedisCodecResult<T> PRedisClient::get(PStringRef key, T &value)
+    {
+        begin_command(2).arg("GET", 3).arg(key);
+        return exec_decode("GET", key, value);
+    }
+
+    template <typename T>
+    PRedisCodecResult<T> PRedisClient::hset(PStringRef key, PStringRef field, const T &value)
+    {
+        PRespWriter writer = begin_command(4);
+        writer.arg("HSET", 4).arg(key).arg(field);
+        encode_value(writer, value);
+        return exec_count("HSET", key);
+    }
+
+    template <typename T>
+    PRedisCodecResult<T> PRedisClient::hget(PStringRef key, PStringRef field, T &value)
+    {
+        begin_command(3).arg("HGET", 4).arg(key).arg(field);
+        return exec_decode("HGET", key, value);
+    }
+
+    template <typename T>
+    PRedisHashResult<T> PRedisClient::hset(PStringRef key, const T &obj)
+    {
+        const PRedisHashLayout<T> &layout = PRedisHashLayout<T>::instance();
+
+        PRespWriter writer = begin_command(layout.hset_prefix());
+        writer.arg(key);
+
+        PRedisHashEncoder<T> encoder(writer, layout, compressor_.get(), value_buf_);
+        PRedisHashMapping<T>::visit(obj, encoder);
+        if (encoder.compress_failed()) {
+            log_compress_error();
+        }
+
+        return exec_count("HSET", key);
+    }
+
+    template <typename T>
+    PRedisHashResult<T> PRedisClient::hmget(PStringRef key, T &obj)
+    {
+        const PRedisHashLayout<T> &layout = PRedisHashLayout<T>::instance();
+
+        PRespWriter writer = begin_command(layout.hmget_prefix());
+        writer.arg(key).raw(layout.hmget_fields().data(), layout.hmget_fields().size());
+
+        redisReply *r = exec_command("HMGET", key, REDIS_REPLY_ARRAY);
+        if (nullptr == r || r->type != REDIS_REPLY_ARRAY) {
+            return -1;
+        }
+        if (r->elements != PRedisHashMapping<T>::size) {
+            return report_error("HMGET", key, PREDIS_ERR_TYPE, "unexpected number of elements");
+        }
+
+        PRedisHashDecoder decoder(r, compressor_.get());
+        PRedisHashMapping<T>::visit(obj, decoder);
+        if (!decoder.ok()) {
+            return report_error("HMGET", key, PREDIS_ERR_DECODE, decoder.error());
+        }
+
+        return decoder.found();
+    }
+
+    template <typename Iter>
+    int PRedisClient::mget(Iter first, Iter last, std::vector<std::string> &values)
+    {
+        PRespWriter writer = begin_command(1 + std::distance(first, last));
+        writer.arg("MGET", 4);
+        append_args(writer, first, last);
+        return exec_values("MGET", PStringRef(), values);
+    }
+
+    template <typename Iter>
+    int PRedisClient::del(Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(1 + std::distance(first, last));
+        writer.arg("DEL", 3);
+        append_args(writer, first, last);
+        return exec_count("DEL", PStringRef());
+    }
+
+    template <typename Iter>
+    int PRedisClient::sadd(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("SADD", 4).arg(key);
+        append_args(writer, first, last);
+        return exec_count("SADD", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::hmset(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + 2 * std::distance(first, last));
+        writer.arg("HMSET", 5).arg(key);
+        append_value_pairs(writer, first, last);
+        return exec_status("HMSET", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::hmget(PStringRef key, Iter first, Iter last, std::vector<std::string> &values)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("HMGET", 5).arg(key);
+        append_args(writer, first, last);
+        return exec_values("HMGET", key, values);
+    }
+
+    template <typename Iter>
+    int PRedisClient::hdel(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("HDEL", 4).arg(key);
+        append_args(writer, first, last);
+        return exec_count("HDEL", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::lpush(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("LPUSH", 5).arg(key);
+        append_args(writer, first, last);
+        return exec_count("LPUSH", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::rpush(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("RPUSH", 5).arg(key);
+        append_args(writer, first, last);
+        return exec_count("RPUSH", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::zadd(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + 2 * std::distance(first, last));
+        writer.arg("ZADD", 4).arg(key);
+        for (; first != last; ++first) {
+            writer.arg(static_cast<long long>(first->first));
+            writer.arg(PStringRef(first->second));
+        }
+        return exec_count("ZADD", key);
+    }
+
+    template <typename Iter>
+    int PRedisClient::zrem(PStringRef key, Iter first, Iter last)
+    {
+        PRespWriter writer = begin_command(2 + std::distance(first, last));
+        writer.arg("ZREM", 4).arg(key);
+        append_args(writer, first, last);
+        return exec_count("ZREM", key);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::keys(PStringRef pattern, PBasicRedisStringList<Chars, Offsets> &out)
+    {
+        begin_command(2).arg("KEYS", 4).arg(pattern);
+        return exec_list("KEYS", pattern, out);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::smembers(PStringRef key, PBasicRedisStringList<Chars, Offsets> &values)
+    {
+        begin_command(2).arg("SMEMBERS", 8).arg(key);
+        return exec_list("SMEMBERS", key, values);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::hgetall(PStringRef key, PBasicRedisStringList<Chars, Offsets> &field_values)
+    {
+        begin_command(2).arg("HGETALL", 7).arg(key);
+
+        redisReply *r = exec_command("HGETALL", key, REDIS_REPLY_ARRAY);
+        if (nullptr == r) {
+            return -1;
+        }
+        if (r->type == REDIS_REPLY_NIL) {
+            return 0;
+        }
+        if (r->elements % 2 != 0) {
+            return report_error("HGETALL", key, PREDIS_ERR_TYPE, "odd number of elements");
+        }
+        if (!compressor_) {
+            return static_cast<int>(field_values.append(r) / 2);
+        }
+
+        for (size_t i = 0; i < r->elements; i += 2) {
+            PStringRef value;
+            if (0 != read_element(r->element[i+1], value)) {
+                return report_error("HGETALL", key, PREDIS_ERR_DECODE, compressor_->error());
+            }
+            field_values.push_back(PStringRef(r->element[i]->str, r->element[i]->len));
+            field_values.push_back(value);
+        }
+        phase_timer_.decoded();
+
+        return static_cast<int>(r->elements / 2);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::hkeys(PStringRef key, PBasicRedisStringList<Chars, Offsets> &out)
+    {
+        begin_command(2).arg("HKEYS", 5).arg(key);
+        return exec_list("HKEYS", key, out);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::hvals(PStringRef key, PBasicRedisStringList<Chars, Offsets> &out)
+    {
+        begin_command(2).arg("HVALS", 5).arg(key);
+        return exec_value_list("HVALS", key, out);
+    }
+
+    template <typename Chars, typename Offsets>
+    int PRedisClient::lrange(PStringRef key, int start, int stop,
+            PBasicRedisStringList<Chars, Offsets> &values)
+    {
+        begin_command(4).arg("LRANGE", 6).arg(key)
+                        .arg(static_cast<long long>(start)).arg(static_cast<long long>(stop));
+        return exec_list("LRANGE", key, values);
+    }
+
+    template <typename Iter>
+    int PRedisClient::xadd(PStringRef key, Iter first, Iter last,
+            std::string &id, size_t maxlen)
+    {
+        size_t argc = 3 + 2 * std::distance(first, last) + (maxlen > 0 ? 3 : 0);
+        PRespWriter writer = begin_command(argc);
+        writer.arg("XADD", 4).arg(key);
+        if (maxlen > 0) {
+            writer.arg("MAXLEN", 6).arg("~", 1).arg(static_cast<long long>(maxlen));
+        }
+        writer.arg("*", 1);
+        append_pairs(writer, first, last);
+
+        redisReply *r = exec_command("XADD", key, REDIS_REPLY_STRING);
+        if (nullptr == r || r->type != REDIS_REPLY_STRING) {
+            return -1;
+        }
+        id.assign(r->str, r->len);
+
+        return 1;
+    }
+
+    template <typename Iter>
+    int PRedisClient::xack(PStringRef key, PStringRef group, Iter first, Iter last)
+    {
+        if (first == last) { return 0; }
+
+        PRespWriter writer = begin_command(3 + std::distance(first, last));
+        writer.arg("XACK", 4).arg(key).arg(group);
+        append_args(writer, first, last);
+        return exec_count("XACK", key);
+    }
+
 }
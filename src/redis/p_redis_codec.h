@@ -0,0 +1,183 @@
+/*
+ * FileName : p_redis_codec.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 21 Oct 2026 10:14:37 AM CST   Created
+*/
+
+#pragma once
+
+#include "p_string_ref.h"
+
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <stddef.h>
+#include <string.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief PRedisClient::get<T>/set<T>/hget<T>/hset<T> 使用的值编解码
+     *
+     * 为类型 T 提供编解码时特化 PRedisCodec<T>, 需要三个静态函数:
+     *   static size_t size(const T &value);               编码后的字节数
+     *   static void encode(const T &value, char *out);    写入恰好 size() 字节
+     *   static bool decode(const char *data, size_t len, T &value);
+     * 编码直接写进命令缓冲区, 解码直接读回复的内存, 中间没有临时 std::string.
+     *
+     * 已有的实现:
+     *   - 可平凡复制的结构体: 按内存原样存储, 长度不符时解码失败
+     *   - 整数: 十进制文本, 与 INCR 等命令兼容
+     *   - std::string: 原样存储
+     *   - protobuf 消息: 见 p_redis_codec_protobuf.h
+     */
+    template <typename T, typename Enable = void>
+    struct PRedisCodec
+    {
+    };
+
+    template <typename T>
+    struct PRedisCodec<T, typename std::enable_if<std::is_class<T>::value
+                                                  && std::is_trivially_copyable<T>::value>::type>
+    {
+        static size_t size(const T &)
+        {
+            return sizeof(T);
+        }
+
+        static void encode(const T &value, char *out)
+        {
+            memcpy(out, &value, sizeof(T));
+        }
+
+        static bool decode(const char *data, size_t len, T &value)
+        {
+            if (len != sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, data, sizeof(T));
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct PRedisCodec<T, typename std::enable_if<std::is_integral<T>::value>::type>
+    {
+        static size_t size(const T &value)
+        {
+            char tmp[24];
+            return format(tmp, value);
+        }
+
+        static void encode(const T &value, char *out)
+        {
+            format(out, value);
+        }
+
+        static bool decode(const char *data, size_t len, T &value)
+        {
+            size_t i = 0;
+            bool negative = false;
+            if (len > 0 && data[0] == '-' && std::is_signed<T>::value) {
+                negative = true;
+                ++i;
+            }
+            if (i == len) {
+                return false;
+            }
+
+            /* 负数的上限是 |min|, 比 max 大 1; 逐位检查, 越界返回 false 而不是回绕 */
+            unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<T>::max());
+            if (negative) {
+                limit += 1;
+            }
+            unsigned long long v = 0;
+            for (; i < len; ++i) {
+                if (data[i] < '0' || data[i] > '9') {
+                    return false;
+                }
+                unsigned long long digit = static_cast<unsigned long long>(data[i] - '0');
+                if (v > limit / 10 || (v == limit / 10 && digit > limit % 10)) {
+                    return false;
+                }
+                v = v * 10 + digit;
+            }
+            value = negative ? static_cast<T>(-static_cast<long long>(v - 1) - 1) : static_cast<T>(v);
+            return true;
+        }
+
+        static size_t format(char *out, T value)
+        {
+            char tmp[24];
+            char *p = tmp + sizeof(tmp);
+            bool negative = is_negative(value, std::is_signed<T>());
+            unsigned long long v = negative
+                ? 0ULL - static_cast<unsigned long long>(static_cast<long long>(value))
+                : static_cast<unsigned long long>(value);
+            do {
+                *--p = static_cast<char>('0' + v % 10);
+                v /= 10;
+            } while (v != 0);
+            if (negative) {
+                *--p = '-';
+            }
+
+            size_t len = static_cast<size_t>(tmp + sizeof(tmp) - p);
+            memcpy(out, p, len);
+            return len;
+        }
+
+    private:
+        static bool is_negative(T value, std::true_type) { return value < 0; }
+        static bool is_negative(T, std::false_type) { return false; }
+    };
+
+    /*
+     * @brief std::string 原样存储, 主要供 PRedisHashMapping 的字符串成员使用
+     */
+    template <>
+    struct PRedisCodec<std::string>
+    {
+        static size_t size(const std::string &value)
+        {
+            return value.size();
+        }
+
+        static void encode(const std::string &value, char *out)
+        {
+            memcpy(out, value.data(), value.size());
+        }
+
+        static bool decode(const char *data, size_t len, std::string &value)
+        {
+            value.assign(data, len);
+            return true;
+        }
+    };
+
+    /*
+     * @brief T 有可用的 PRedisCodec 且不能直接作为字符串参数时为 true,
+     * 字符串类的值仍然走 PStringRef 版本的接口
+     */
+    template <typename T>
+    struct PRedisHasCodec
+    {
+        private:
+            template <typename U>
+            static char test(decltype(PRedisCodec<U>::size(std::declval<const U &>())) *);
+
+            template <typename U>
+            static long test(...);
+
+        public:
+            static const bool value = sizeof(test<T>(nullptr)) == 1
+                                   && !std::is_convertible<const T &, PStringRef>::value;
+    };
+
+    template <typename T, typename R = int>
+    using PRedisCodecResult = typename std::enable_if<PRedisHasCodec<T>::value, R>::type;
+
+}
@@ -0,0 +1,49 @@
+/*
+ * FileName : p_redis_codec_protobuf.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 21 Oct 2026 10:14:37 AM CST   Created
+*/
+
+#pragma once
+
+#include "p_redis_codec.h"
+
+#include <google/protobuf/message_lite.h>
+
+#include <limits>
+#include <type_traits>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief protobuf 消息按二进制格式存储
+     * 需要链接 protobuf, 所以单独放在这个头文件里, 使用时再包含
+     */
+    template <typename T>
+    struct PRedisCodec<T, typename std::enable_if<
+            std::is_base_of<google::protobuf::MessageLite, T>::value>::type>
+    {
+        static size_t size(const T &value)
+        {
+            return value.ByteSizeLong();
+        }
+
+        /* size() 已经计算并缓存了各字段的长度, 这里直接序列化 */
+        static void encode(const T &value, char *out)
+        {
+            value.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(out));
+        }
+
+        static bool decode(const char *data, size_t len, T &value)
+        {
+            if (len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+                return false;
+            }
+            return value.ParseFromArray(data, static_cast<int>(len));
+        }
+    };
+
+}
@@ -0,0 +1,260 @@
+/*
+ * FileName : p_redis_compressor.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 22 Oct 2026 11:02:46 AM CST   Created
+*/
+
+#include "p_redis_compressor.h"
+
+#include <libpc/pc_logger.h>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <string.h>
+#include <time.h>
+
+using namespace pepper;
+
+/* redis 单个值的上限 */
+static const size_t s_max_value_size = 512 << 20;
+
+static const char s_magic[3] = { '\xF5', 'P', 'Z' };
+
+static uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+PRedisCompressor::PRedisCompressor(const PRedisCompressionOptions &options)
+    : options_(options), error_(nullptr), cctx_(nullptr), dctx_(nullptr), cdict_(nullptr), ddict_(nullptr),
+      poor_streak_(0), bypass_left_(0)
+{
+}
+
+PRedisCompressor::~PRedisCompressor()
+{
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+    ZSTD_freeCCtx(cctx_);
+    ZSTD_freeDCtx(dctx_);
+}
+
+int PRedisCompressor::init()
+{
+    cctx_ = ZSTD_createCCtx();
+    dctx_ = ZSTD_createDCtx();
+    if (nullptr == cctx_ || nullptr == dctx_) {
+        pc_log_error("compressor init error: create zstd context failed");
+        return -1;
+    }
+
+    if (!options_.dictionary.empty()) {
+        const std::string &dict = options_.dictionary;
+        cdict_ = ZSTD_createCDict(dict.data(), dict.size(), options_.level);
+        ddict_ = ZSTD_createDDict(dict.data(), dict.size());
+        if (nullptr == cdict_ || nullptr == ddict_) {
+            pc_log_error("compressor init error: invalid dictionary of %zu bytes", dict.size());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int PRedisCompressor::write_arg(PRespWriter &writer, PStringRef value)
+{
+    size_t min_size = cdict_ != nullptr ? options_.dictionary_threshold : options_.threshold;
+    if (value.size() < min_size) {
+        ++stats_.stored_raw;
+        write_raw(writer, value);
+        return 0;
+    }
+    if (bypass_left_ > 0) {
+        --bypass_left_;
+        ++stats_.bypassed;
+        write_raw(writer, value);
+        return 0;
+    }
+
+    uint64_t start = monotonic_ns();
+    int tag = compress(value);
+    stats_.compress_ns += monotonic_ns() - start;
+
+    if (tag < 0) {
+        ++stats_.errors;
+        ++stats_.stored_raw;
+        write_raw(writer, value);
+        return -1;
+    }
+    if (0 == tag) {
+        ++stats_.stored_raw;
+        if (++poor_streak_ >= options_.bypass_after && options_.bypass_after > 0) {
+            poor_streak_ = 0;
+            bypass_left_ = options_.bypass_count;
+        }
+        write_raw(writer, value);
+        return 0;
+    }
+
+    poor_streak_ = 0;
+    ++stats_.compressed;
+    stats_.raw_bytes    += value.size();
+    stats_.stored_bytes += kHeaderSize + scratch_.size();
+
+    write_header(writer, tag, scratch_.size());
+    writer.raw(scratch_.data(), scratch_.size()).arg_end();
+
+    return 0;
+}
+
+void PRedisCompressor::write_raw(PRespWriter &writer, PStringRef value)
+{
+    if (value.size() < sizeof(s_magic) || 0 != memcmp(value.data(), s_magic, sizeof(s_magic))) {
+        writer.arg(value);
+        return;
+    }
+
+    write_header(writer, TAG_RAW, value.size());
+    writer.raw(value.data(), value.size()).arg_end();
+}
+
+void PRedisCompressor::write_header(PRespWriter &writer, int tag, size_t payload_len)
+{
+    char tag_byte = static_cast<char>(tag);
+    writer.arg_header(kHeaderSize + payload_len);
+    writer.raw(s_magic, sizeof(s_magic)).raw(&tag_byte, 1);
+}
+
+int PRedisCompressor::header_tag(PStringRef stored)
+{
+    if (stored.size() < kHeaderSize || 0 != memcmp(stored.data(), s_magic, sizeof(s_magic))) {
+        return 0;
+    }
+
+    int tag = static_cast<unsigned char>(stored.data()[sizeof(s_magic)]);
+    return tag >= TAG_RAW && tag <= TAG_ZSTD_DICT ? tag : 0;
+}
+
+/*
+ * 压缩结果写到复用的 scratch_, 稳定状态下没有内存分配;
+ * 效果差返回 0, 出错返回 -1, 出错原因在 error_
+ */
+int PRedisCompressor::compress(PStringRef value)
+{
+    int tag = 0;
+    size_t len = 0;
+
+    if (cdict_ != nullptr && value.size() < options_.threshold) {
+        scratch_.resize(ZSTD_compressBound(value.size()));
+        len = ZSTD_compress_usingCDict(cctx_, &scratch_[0], scratch_.size(),
+                                       value.data(), value.size(), cdict_);
+        if (ZSTD_isError(len)) {
+            error_ = ZSTD_getErrorName(len);
+            return -1;
+        }
+        tag = TAG_ZSTD_DICT;
+    } else if (options_.algorithm == PRedisCompressionOptions::ALGO_ZSTD) {
+        scratch_.resize(ZSTD_compressBound(value.size()));
+        len = ZSTD_compressCCtx(cctx_, &scratch_[0], scratch_.size(),
+                                value.data(), value.size(), options_.level);
+        if (ZSTD_isError(len)) {
+            error_ = ZSTD_getErrorName(len);
+            return -1;
+        }
+        tag = TAG_ZSTD;
+    } else {
+        if (value.size() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+            return 0;
+        }
+        int src_len = static_cast<int>(value.size());
+        scratch_.resize(4 + static_cast<size_t>(LZ4_compressBound(src_len)));
+        int n = LZ4_compress_fast(value.data(), &scratch_[4], src_len,
+                                  static_cast<int>(scratch_.size() - 4),
+                                  options_.level > 0 ? options_.level : 1);
+        if (n <= 0) {
+            return 0;
+        }
+        uint32_t raw_len = static_cast<uint32_t>(value.size());
+        scratch_[0] = static_cast<char>(raw_len & 0xFF);
+        scratch_[1] = static_cast<char>((raw_len >> 8) & 0xFF);
+        scratch_[2] = static_cast<char>((raw_len >> 16) & 0xFF);
+        scratch_[3] = static_cast<char>((raw_len >> 24) & 0xFF);
+        len = 4 + static_cast<size_t>(n);
+        tag = TAG_LZ4;
+    }
+
+    scratch_.resize(len);
+    if (static_cast<double>(kHeaderSize + len) > options_.max_ratio * static_cast<double>(value.size())) {
+        return 0;
+    }
+
+    return tag;
+}
+
+int PRedisCompressor::fail(const char *message)
+{
+    error_ = message;
+    ++stats_.errors;
+
+    return -1;
+}
+
+int PRedisCompressor::read(PStringRef stored, PStringRef &value)
+{
+    int tag = header_tag(stored);
+    if (0 == tag) {
+        value = stored;
+        return 0;
+    }
+
+    const char *data = stored.data() + kHeaderSize;
+    size_t len = stored.size() - kHeaderSize;
+    if (tag == TAG_RAW) {
+        value = PStringRef(data, len);
+        return 0;
+    }
+
+    uint64_t start = monotonic_ns();
+    if (tag == TAG_LZ4) {
+        if (len < 4) {
+            return fail("truncated lz4 value");
+        }
+        const unsigned char *u = reinterpret_cast<const unsigned char *>(data);
+        size_t raw_len = static_cast<size_t>(u[0]) | (static_cast<size_t>(u[1]) << 8)
+                       | (static_cast<size_t>(u[2]) << 16) | (static_cast<size_t>(u[3]) << 24);
+        if (raw_len > s_max_value_size || len - 4 > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+            return fail("bad lz4 length");
+        }
+        buffer_.resize(raw_len);
+        int n = LZ4_decompress_safe(data + 4, &buffer_[0], static_cast<int>(len - 4),
+                                    static_cast<int>(raw_len));
+        if (n < 0 || static_cast<size_t>(n) != raw_len) {
+            return fail("corrupted lz4 value");
+        }
+    } else {
+        if (tag == TAG_ZSTD_DICT && nullptr == ddict_) {
+            return fail("value needs a dictionary");
+        }
+        unsigned long long raw_len = ZSTD_getFrameContentSize(data, len);
+        if (raw_len == ZSTD_CONTENTSIZE_ERROR || raw_len == ZSTD_CONTENTSIZE_UNKNOWN
+                || raw_len > s_max_value_size) {
+            return fail("bad zstd frame");
+        }
+        buffer_.resize(static_cast<size_t>(raw_len));
+        size_t n = tag == TAG_ZSTD_DICT
+            ? ZSTD_decompress_usingDDict(dctx_, &buffer_[0], buffer_.size(), data, len, ddict_)
+            : ZSTD_decompressDCtx(dctx_, &buffer_[0], buffer_.size(), data, len);
+        if (ZSTD_isError(n) || n != raw_len) {
+            return fail(ZSTD_isError(n) ? ZSTD_getErrorName(n) : "zstd size mismatch");
+        }
+    }
+    stats_.decompress_ns += monotonic_ns() - start;
+    ++stats_.decompressed;
+
+    value = PStringRef(buffer_.data(), buffer_.size());
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * FileName : p_redis_compressor.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 22 Oct 2026 11:02:46 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_resp.h"
+#include "p_string_ref.h"
+
+#include <string>
+
+#include <stdint.h>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace pepper
+{
+
+    struct PRedisCompressionOptions
+    {
+        enum Algorithm
+        {
+            ALGO_LZ4,
+            ALGO_ZSTD
+        };
+
+        Algorithm   algorithm    = ALGO_LZ4;
+        int         level        = 1;           /* zstd 压缩级别, lz4 的 acceleration */
+        size_t      threshold    = 1024;        /* 不小于该长度的值才压缩 */
+
+        /*
+         * zstd 训练好的共享字典 (zstd --train 的输出), 为空不使用.
+         * 长度在 [dictionary_threshold, threshold) 之间的小值用字典压缩,
+         * 更大的值仍按 algorithm 压缩
+         */
+        std::string dictionary;
+        size_t      dictionary_threshold = 64;
+
+        /* 压缩后/压缩前 大于 max_ratio 视为效果差, 按原值存储 */
+        double      max_ratio    = 0.9;
+
+        /* 连续 bypass_after 次效果差后, 之后 bypass_count 个值直接存原值, 然后再试 */
+        uint32_t    bypass_after = 8;
+        uint32_t    bypass_count = 256;
+    };
+
+    struct PRedisCompressionStats
+    {
+        uint64_t compressed      = 0;   /* 压缩存储的值 */
+        uint64_t stored_raw      = 0;   /* 未达到阈值或效果差, 按原值存储 */
+        uint64_t bypassed        = 0;   /* 处于跳过期, 没有尝试压缩 */
+        uint64_t decompressed    = 0;
+        uint64_t errors          = 0;   /* 压缩出错 (按原值存储) 和解压失败 */
+        uint64_t raw_bytes       = 0;   /* 压缩存储的值压缩前的字节数 */
+        uint64_t stored_bytes    = 0;   /* 压缩存储的值压缩后的字节数 */
+        uint64_t compress_ns     = 0;   /* 压缩耗时, 包括效果差被丢弃的 */
+        uint64_t decompress_ns   = 0;
+
+        /* 压缩后/压缩前, 没有压缩过返回 1 */
+        double ratio() const
+        {
+            return raw_bytes > 0 ? static_cast<double>(stored_bytes) / static_cast<double>(raw_bytes) : 1.0;
+        }
+    };
+
+    /*
+     * @brief 值的透明压缩, 由 PRedisClient::enable_compression 开启
+     *
+     * 存储格式: 压缩过的值以 4 字节头开始, 0xF5 'P' 'Z' 之后是格式:
+     *   0x01 原值 (开启压缩时, 原值恰好以 0xF5 'P' 'Z' 开头才加)
+     *   0x02 lz4, 之后 4 字节小端原始长度, 然后是 lz4 block
+     *   0x03 zstd frame
+     *   0x04 使用字典的 zstd frame
+     * 没有这个头的值原样返回. 0xF5 不会出现在 UTF-8 文本的开头, protobuf 等
+     * 二进制值要恰好以这 4 个字节开头才会被误认, 所以开启压缩前写入的值
+     * 和不压缩的客户端写入的值都可以直接读.
+     */
+    class PRedisCompressor : public noncopyable
+    {
+        public:
+            explicit PRedisCompressor(const PRedisCompressionOptions &options);
+            ~PRedisCompressor();
+
+            /* return 0 成功  -1 字典无效 */
+            int init();
+
+            /*
+             * @brief 按存储格式把 value 作为一个参数写入 writer
+             * return 0 成功  -1 压缩出错, 已按原值写入, 原因见 error()
+             */
+            int write_arg(PRespWriter &writer, PStringRef value);
+
+            /*
+             * @brief 还原存储的值, 未压缩时 value 直接指向 stored,
+             * 否则指向内部缓冲区, 在下一次调用前有效
+             * return 0 成功  -1 数据损坏或缺少字典, 原因见 error()
+             */
+            int read(PStringRef stored, PStringRef &value);
+
+            /*
+             * @brief 最近一次失败的原因, 静态字符串.
+             * 这里不输出日志, 由调用者按自己的限流输出
+             */
+            const char *error() const { return error_ != nullptr ? error_ : "unknown error"; }
+
+            const PRedisCompressionStats &stats() const { return stats_; }
+
+        private:
+            enum Tag
+            {
+                TAG_RAW       = 0x01,
+                TAG_LZ4       = 0x02,
+                TAG_ZSTD      = 0x03,
+                TAG_ZSTD_DICT = 0x04
+            };
+
+            static const size_t kHeaderSize = 4;
+
+            /* 以 0xF5 'P' 'Z' 开头时返回之后的格式字节, 否则返回 0 */
+            static int header_tag(PStringRef stored);
+
+            void write_header(PRespWriter &writer, int tag, size_t payload_len);
+
+            /* 压缩到 scratch_, 返回标记, 效果差返回 0, 出错返回 -1 */
+            int compress(PStringRef value);
+
+            /* 记录解压失败的原因, 返回 -1 */
+            int fail(const char *message);
+
+            void write_raw(PRespWriter &writer, PStringRef value);
+
+            PRedisCompressionOptions options_;
+            PRedisCompressionStats   stats_;
+            const char              *error_;
+
+            ZSTD_CCtx_s             *cctx_;
+            ZSTD_DCtx_s             *dctx_;
+            ZSTD_CDict_s            *cdict_;
+            ZSTD_DDict_s            *ddict_;
+
+            uint32_t                 poor_streak_;
+            uint32_t                 bypass_left_;
+
+            std::string              scratch_;      /* 压缩输出 */
+            std::string              buffer_;       /* 解压输出 */
+    };
+
+}
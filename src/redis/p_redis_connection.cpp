@@ -0,0 +1,277 @@
+/*
+ * FileName : p_redis_connection.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 04:52:31 PM CST   Created
+*/
+
+#include "p_redis_connection.h"
+#include "p_redis_sentinel.h"
+
+#include <libpc/pc_logger.h>
+
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace pepper;
+
+void PRedisArgv::reset()
+{
+    argv_.clear();
+    argvlen_.clear();
+    numbers_used_ = 0;
+}
+
+void PRedisArgv::push(const char *arg, size_t len)
+{
+    argv_.push_back(arg);
+    argvlen_.push_back(len);
+}
+
+void PRedisArgv::push(const char *arg)
+{
+    push(arg, strlen(arg));
+}
+
+void PRedisArgv::push(const std::string &arg)
+{
+    push(arg.data(), arg.size());
+}
+
+void PRedisArgv::push(long long value)
+{
+    if (numbers_used_ == numbers_.size()) {
+        numbers_.push_back(Number());
+    }
+    char *buf = numbers_[numbers_used_++].buf;
+    int len = snprintf(buf, sizeof(Number::buf), "%lld", value);
+    push(buf, static_cast<size_t>(len));
+}
+
+PRedisConnection::PRedisConnection(const std::string &host, int port)
+    : host_(host), port_(port), redis_context_(nullptr),
+      timeout_ms_(0), cur_timeout_ms_(0), pending_(0), endpoint_generation_(0)
+{
+}
+
+PRedisConnection::~PRedisConnection()
+{
+    close();
+}
+
+void PRedisConnection::set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint)
+{
+    endpoint_            = endpoint;
+    endpoint_generation_ = 0;
+}
+
+bool PRedisConnection::update_address()
+{
+    std::string host;
+    int port = 0;
+    endpoint_generation_ = endpoint_->get(host, port);
+    if (host.empty() || (host == host_ && port == port_)) {
+        return false;
+    }
+    host_ = host;
+    port_ = port;
+
+    return true;
+}
+
+int PRedisConnection::connect(uint32_t timeout_ms)
+{
+    close();
+    if (endpoint_) {
+        update_address();
+    }
+
+    struct timeval tv;
+    tv.tv_sec  = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+    timeout_ms_     = timeout_ms;
+    cur_timeout_ms_ = timeout_ms;
+
+    redis_context_ = redisConnectWithTimeout(host_.c_str(), port_, tv);
+    if (nullptr == redis_context_) {
+        pc_log_error("connect %s:%d error: context is nullptr", host_.c_str(), port_);
+        return -1;
+    }
+    if (redis_context_->err) {
+        pc_log_error("connect %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+        close();
+        return -1;
+    }
+    reply_pool_.attach(redis_context_);
+
+    return 0;
+}
+
+/*
+ * 还有等待回复的命令时不切换, 否则这些回复会丢失; 等读完后的下一条命令再切换
+ */
+int PRedisConnection::ensure_connected()
+{
+    if (endpoint_ && 0 == pending_ && endpoint_->generation() != endpoint_generation_
+            && update_address()) {
+        close();
+    }
+    if (nullptr != redis_context_) { return 0; }
+
+    return connect(timeout_ms_);
+}
+
+void PRedisConnection::close()
+{
+    if (nullptr != redis_context_) {
+        redisFree(redis_context_);
+        redis_context_ = nullptr;
+    }
+    pending_ = 0;
+}
+
+int PRedisConnection::set_timeout(uint32_t timeout_ms)
+{
+    if (0 != ensure_connected()) { return -1; }
+    if (timeout_ms == cur_timeout_ms_) { return 0; }
+
+    struct timeval tv;
+    tv.tv_sec  = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    if (REDIS_OK != redisSetTimeout(redis_context_, tv)) {
+        pc_log_error("set timeout %s:%d %u error: %s", host_.c_str(), port_,
+                     timeout_ms, redis_context_->errstr);
+        close();
+        return -1;
+    }
+    cur_timeout_ms_ = timeout_ms;
+
+    return 0;
+}
+
+/*
+ * 阻塞时长必须小于 socket 的读超时, 否则会被误判为连接异常.
+ */
+int PRedisConnection::set_block_timeout(int block_ms)
+{
+    if (block_ms < 0) {
+        return set_timeout(timeout_ms_);
+    }
+    if (block_ms == 0) {
+        return set_timeout(0);
+    }
+
+    return set_timeout(static_cast<uint32_t>(block_ms) + timeout_ms_);
+}
+
+int PRedisConnection::append(PRedisArgv &args)
+{
+    if (0 != ensure_connected()) { return -1; }
+
+    if (REDIS_OK != redisAppendCommandArgv(redis_context_, args.argc(),
+                                           args.argv(), args.argvlen())) {
+        pc_log_error("append %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+        close();
+        return -1;
+    }
+    ++pending_;
+
+    return 0;
+}
+
+int PRedisConnection::read_reply(PRedisReply &reply)
+{
+    if (nullptr == redis_context_) { return -1; }
+
+    void *aux = nullptr;
+    if (REDIS_OK != redisGetReply(redis_context_, &aux) || nullptr == aux) {
+        pc_log_error("read reply %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+        close();
+        return -1;
+    }
+    reply.reset(static_cast<redisReply *>(aux), redis_context_->reader->fn->freeObject);
+    if (pending_ > 0) {
+        --pending_;
+    }
+
+    return 0;
+}
+
+int PRedisConnection::poll_reply(PRedisReply &reply, bool readable)
+{
+    if (nullptr == redis_context_) { return -1; }
+
+    void *aux = nullptr;
+    if (REDIS_OK != redisGetReplyFromReader(redis_context_, &aux)) {
+        pc_log_error("read reply %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+        close();
+        return -1;
+    }
+    if (nullptr == aux && readable) {
+        if (REDIS_OK != redisBufferRead(redis_context_)
+                || REDIS_OK != redisGetReplyFromReader(redis_context_, &aux)) {
+            pc_log_error("read reply %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+            close();
+            return -1;
+        }
+    }
+    if (nullptr == aux) {
+        return 0;
+    }
+    reply.reset(static_cast<redisReply *>(aux), redis_context_->reader->fn->freeObject);
+    if (pending_ > 0) {
+        --pending_;
+    }
+
+    return 1;
+}
+
+int PRedisConnection::flush()
+{
+    if (0 != ensure_connected()) { return -1; }
+
+    int done = 0;
+    while (!done) {
+        if (REDIS_OK != redisBufferWrite(redis_context_, &done)) {
+            pc_log_error("write %s:%d error: %s", host_.c_str(), port_, redis_context_->errstr);
+            close();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int PRedisConnection::write_raw(const char *buf, size_t len, size_t commands)
+{
+    if (0 != flush()) { return -1; }
+
+    while (len > 0) {
+        ssize_t nwritten = ::write(redis_context_->fd, buf, len);
+        if (nwritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            pc_log_error("write %s:%d error: %s", host_.c_str(), port_, strerror(errno));
+            close();
+            return -1;
+        }
+        buf += nwritten;
+        len -= static_cast<size_t>(nwritten);
+    }
+    pending_ += commands;
+
+    return 0;
+}
+
+PRedisReply PRedisConnection::command(PRedisArgv &args)
+{
+    PRedisReply reply;
+    if (0 != append(args) || 0 != read_reply(reply)) {
+        return PRedisReply();
+    }
+
+    return reply;
+}
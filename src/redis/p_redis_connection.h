@@ -0,0 +1,161 @@
+/*
+ * FileName : p_redis_connection.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 04:52:31 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "hiredis.h"
+#include "p_redis_reply.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    class PRedisEndpoint;
+
+    /*
+     * @brief redisCommandArgv/redisAppendCommandArgv 的参数表
+     * 只保存指针和长度, 参数内容由调用方保证在发送前有效;
+     * 整数参数格式化到内部缓冲区中, reset() 后缓冲区复用
+     */
+    class PRedisArgv
+    {
+        public:
+            PRedisArgv() : numbers_used_(0) {}
+
+            void reset();
+
+            void push(const char *arg, size_t len);
+            void push(const char *arg);
+            void push(const std::string &arg);
+            void push(long long value);
+
+            int argc() const { return static_cast<int>(argv_.size()); }
+            const char **argv() { return argv_.data(); }
+            const size_t *argvlen() const { return argvlen_.data(); }
+
+        private:
+            struct Number
+            {
+                char buf[24];
+            };
+
+            std::vector<const char *> argv_;
+            std::vector<size_t>       argvlen_;
+            std::deque<Number>        numbers_;
+            size_t                    numbers_used_;
+    };
+
+    /*
+     * @brief 独占的一条阻塞连接
+     *
+     * 用于 BLMOVE/XREADGROUP BLOCK 这类会长时间占住连接的命令,
+     * 或需要自己控制 pipeline 的场景. 出现 IO 错误后连接会被关闭,
+     * 下一次调用 ensure_connected() 时重新建立.
+     *
+     * 设置了 endpoint 时, 每次发送命令前 (连接上没有等待回复的命令时)
+     * 检查其 generation, 地址变化后关闭连接并连到新地址.
+     */
+    class PRedisConnection : public noncopyable
+    {
+        public:
+            PRedisConnection(const std::string &host, int port);
+            ~PRedisConnection();
+
+            /*
+             * @brief 建立连接, timeout_ms 为连接及默认读写超时
+             * return 0 成功 -1 失败
+             */
+            int connect(uint32_t timeout_ms);
+            int ensure_connected();
+            void close();
+            bool connected() const { return redis_context_ != nullptr; }
+
+            /* 跟随 endpoint 的地址 (一般来自 PRedisSentinel), 见类说明 */
+            void set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /*
+             * @brief 设置读写超时, 0 表示一直等待
+             * 与当前值相同时不做系统调用
+             */
+            int set_timeout(uint32_t timeout_ms);
+
+            /*
+             * @brief 阻塞命令需要的读超时: 阻塞时长 + 默认超时
+             * @param block_ms <0 非阻塞命令, 0 一直阻塞
+             */
+            int set_block_timeout(int block_ms);
+
+            /*
+             * @brief 追加命令到输出缓冲, 不发送
+             * return 0 成功 -1 失败
+             */
+            int append(PRedisArgv &args);
+
+            /*
+             * @brief 读取一个回复, 必要时先发送输出缓冲
+             * 回复节点来自连接的 PRedisReplyPool, reply 析构或 reset 时回收
+             * return 0 成功 -1 失败(连接已关闭)
+             */
+            int read_reply(PRedisReply &reply);
+
+            /*
+             * @brief 不阻塞地取一个回复: 先解析已读入的数据, 没有完整回复且
+             * readable 为 true 时从 socket 读一次 (调用方已用 poll 确认可读)
+             * return 1 取到回复  0 暂时没有  -1 失败(连接已关闭)
+             */
+            int poll_reply(PRedisReply &reply, bool readable);
+
+            /*
+             * @brief 发送输出缓冲中的全部命令
+             * return 0 成功 -1 失败(连接已关闭)
+             */
+            int flush();
+
+            /*
+             * @brief 把已编码好的 RESP 直接写到 socket, 不经过 hiredis 的输出缓冲
+             * 输出缓冲中尚未发送的命令会先写出, 保证命令顺序
+             * @param commands buf 中的命令数, 用于统计等待回复的命令
+             * return 0 成功 -1 失败(连接已关闭)
+             */
+            int write_raw(const char *buf, size_t len, size_t commands);
+
+            /*
+             * @brief append + read_reply
+             * return 回复, 失败返回空的 PRedisReply
+             */
+            PRedisReply command(PRedisArgv &args);
+
+            const PRedisReplyPool &reply_pool() const { return reply_pool_; }
+
+            const std::string &host() const { return host_; }
+            int port() const { return port_; }
+            redisContext *context() { return redis_context_; }
+            int fd() const { return redis_context_ != nullptr ? redis_context_->fd : -1; }
+
+        private:
+            /* 取 endpoint 的当前地址; return 地址是否变化 */
+            bool update_address();
+
+            std::string     host_;
+            int             port_;
+            PRedisReplyPool reply_pool_;
+            redisContext   *redis_context_;
+            uint32_t        timeout_ms_;
+            uint32_t        cur_timeout_ms_;
+            size_t          pending_;           /* 已发出还没有读到回复的命令数 */
+
+            std::shared_ptr<PRedisEndpoint> endpoint_;
+            uint64_t                        endpoint_generation_;
+    };
+
+}
@@ -0,0 +1,51 @@
+/*
+ * FileName : p_redis_deadline.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 27 Oct 2026 02:36:51 PM CST   Created
+*/
+
+#include "p_redis_deadline.h"
+
+#include <utility>
+
+#include <string.h>
+
+using namespace pepper;
+
+PRedisLatencyWindow &PRedisAdaptiveDeadline::get(const char *cmd)
+{
+    for (auto &entry : entries_) {
+        if (entry.command == cmd || 0 == strcmp(entry.command, cmd)) {
+            return entry.latency;
+        }
+    }
+
+    Entry entry = { cmd, PRedisLatencyWindow(options_.window) };
+    entries_.push_back(std::move(entry));
+
+    return entries_.back().latency;
+}
+
+void PRedisAdaptiveDeadline::add(const char *cmd, uint32_t latency_us)
+{
+    get(cmd).add(latency_us);
+}
+
+uint32_t PRedisAdaptiveDeadline::timeout_us(const char *cmd)
+{
+    uint64_t max_us = options_.max_ms * 1000ULL;
+    uint32_t p = get(cmd).percentile(options_.percentile);
+    if (0 == p) {
+        return static_cast<uint32_t>(max_us);
+    }
+
+    uint64_t us = static_cast<uint64_t>(p * options_.multiplier);
+    if (us < options_.min_ms * 1000ULL) {
+        us = options_.min_ms * 1000ULL;
+    }
+    if (us > max_us) {
+        us = max_us;
+    }
+
+    return static_cast<uint32_t>(us);
+}
@@ -0,0 +1,97 @@
+/*
+ * FileName : p_redis_deadline.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 27 Oct 2026 02:36:51 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_latency.h"
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 取消标记, 由发起 RPC 的一方 (例如客户端断开时) 置位,
+     * 正在等待回复的命令在下一个检查点返回 PREDIS_ERR_CANCELLED
+     * 可以跨线程置位
+     */
+    class PRedisCancelToken : public noncopyable
+    {
+        public:
+            PRedisCancelToken() : cancelled_(false) {}
+
+            void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+            void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+            bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+        private:
+            std::atomic<bool> cancelled_;
+    };
+
+    /*
+     * @brief 命令的截止时间和取消标记, 一般由 RPC 请求剩余的时间构造
+     */
+    struct PRedisDeadline
+    {
+        uint64_t                 at_us  = 0;        /* CLOCK_MONOTONIC 微秒, 0 表示不限 */
+        const PRedisCancelToken *cancel = nullptr;
+
+        static PRedisDeadline after_ms(uint32_t ms, const PRedisCancelToken *cancel = nullptr)
+        {
+            PRedisDeadline deadline;
+            deadline.at_us  = predis_now_us() + ms * 1000ULL;
+            deadline.cancel = cancel;
+            return deadline;
+        }
+
+        bool limited() const { return at_us != 0 || cancel != nullptr; }
+    };
+
+    /*
+     * @brief 没有显式截止时间时按最近的延迟分位数推算:
+     * clamp(percentile * multiplier, min_ms, max_ms)
+     */
+    struct PRedisAdaptiveDeadlineOptions
+    {
+        double   percentile = 0.99;
+        double   multiplier = 3.0;
+        uint32_t min_ms     = 5;
+        uint32_t max_ms     = 1000;
+        uint32_t window     = 1024;
+    };
+
+    /*
+     * @brief 每个命令各自的延迟统计, 命令名只保存指针
+     */
+    class PRedisAdaptiveDeadline
+    {
+        public:
+            explicit PRedisAdaptiveDeadline(const PRedisAdaptiveDeadlineOptions &options)
+                : options_(options) {}
+
+            void add(const char *cmd, uint32_t latency_us);
+
+            /* 样本不足时返回 max_ms 对应的超时 */
+            uint32_t timeout_us(const char *cmd);
+
+        private:
+            struct Entry
+            {
+                const char         *command;
+                PRedisLatencyWindow latency;
+            };
+
+            PRedisLatencyWindow &get(const char *cmd);
+
+            PRedisAdaptiveDeadlineOptions options_;
+            std::vector<Entry>            entries_;
+    };
+
+}
@@ -0,0 +1,238 @@
+/*
+ * FileName : p_redis_delay_queue.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 06:14:45 PM CST   Created
+*/
+
+#include "p_redis_delay_queue.h"
+
+#include <libpc/pc_logger.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace pepper;
+
+/*
+ * KEYS[1] 队列, ARGV[1] 当前时间(ms), ARGV[2] 最多领取的个数
+ * 返回 { 领取到的任务, 下一个任务的到期时间 或 nil }
+ * ZREM 分段 unpack, 避免超过 lua 栈的上限
+ */
+static const char s_claim_script[] =
+    "local due = redis.call('ZRANGEBYSCORE', KEYS[1], '-inf', ARGV[1], 'LIMIT', 0, ARGV[2])\n"
+    "for i = 1, #due, 1000 do\n"
+    "    redis.call('ZREM', KEYS[1], unpack(due, i, math.min(i + 999, #due)))\n"
+    "end\n"
+    "local nxt = redis.call('ZRANGE', KEYS[1], 0, 0, 'WITHSCORES')\n"
+    "return { due, nxt[2] or false }\n";
+
+PRedisDelayQueue::PRedisDelayQueue(const std::string &host, int port, const std::string &key)
+    : connection_(host, port), key_(key), min_poll_ms_(10), max_poll_ms_(1000),
+      last_claim_full_(false), next_due_ms_(-1)
+{
+}
+
+PRedisDelayQueue::~PRedisDelayQueue()
+{
+}
+
+int PRedisDelayQueue::connect(uint32_t timeout_ms)
+{
+    if (0 != connection_.connect(timeout_ms)) {
+        return -1;
+    }
+
+    return load_script();
+}
+
+void PRedisDelayQueue::set_poll_interval(uint32_t min_ms, uint32_t max_ms)
+{
+    min_poll_ms_ = min_ms;
+    max_poll_ms_ = max_ms < min_ms ? min_ms : max_ms;
+}
+
+int PRedisDelayQueue::schedule(const std::string &member, int64_t due_ms)
+{
+    return schedule(std::vector< std::pair<int64_t, std::string> >(1, std::make_pair(due_ms, member)));
+}
+
+int PRedisDelayQueue::schedule(const std::vector< std::pair<int64_t, std::string> > &jobs)
+{
+    if (jobs.empty()) { return 0; }
+
+    args_.reset();
+    args_.push("ZADD", 4);
+    args_.push(key_);
+    for (const auto &job : jobs) {
+        args_.push(static_cast<long long>(job.first));
+        args_.push(job.second);
+    }
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("ZADD %s error: reply is nullptr", key_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_INTEGER) {
+        ret = static_cast<int>(reply->integer);
+        /* 本进程加入的更早任务立即缩短轮询间隔 */
+        for (const auto &job : jobs) {
+            if (next_due_ms_ < 0 || job.first < next_due_ms_) {
+                next_due_ms_ = job.first;
+            }
+        }
+    } else {
+        pc_log_error("ZADD %s error: %s", key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+    }
+
+    return ret;
+}
+
+int PRedisDelayQueue::cancel(const std::string &member)
+{
+    args_.reset();
+    args_.push("ZREM", 4);
+    args_.push(key_);
+    args_.push(member);
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("ZREM %s error: reply is nullptr", key_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_INTEGER) {
+        ret = static_cast<int>(reply->integer);
+    } else {
+        pc_log_error("ZREM %s error: %s", key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+    }
+
+    return ret;
+}
+
+int PRedisDelayQueue::claim(size_t count, std::vector<std::string> &members)
+{
+    if (count == 0) { return 0; }
+
+    PRedisReply reply;
+    if (0 != eval_claim(count, now_ms(), reply)) {
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_ERROR) {
+        pc_log_error("EVALSHA claim %s error: %s", key_.c_str(), reply->str);
+    } else if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 2
+            || reply->element[0]->type != REDIS_REPLY_ARRAY) {
+        pc_log_error("EVALSHA claim %s error: unexpected reply", key_.c_str());
+    } else {
+        const redisReply *due = reply->element[0];
+        members.reserve(members.size() + due->elements);
+        for (size_t i = 0; i < due->elements; ++i) {
+            members.emplace_back(due->element[i]->str, due->element[i]->len);
+        }
+
+        const redisReply *next = reply->element[1];
+        next_due_ms_ = next->type == REDIS_REPLY_STRING ? strtoll(next->str, nullptr, 10) : -1;
+        last_claim_full_ = due->elements >= count;
+        ret = static_cast<int>(due->elements);
+    }
+
+    return ret;
+}
+
+uint32_t PRedisDelayQueue::next_poll_ms() const
+{
+    if (last_claim_full_) {
+        return 0;
+    }
+    if (next_due_ms_ < 0) {
+        return max_poll_ms_;
+    }
+
+    int64_t wait = next_due_ms_ - now_ms();
+    if (wait < static_cast<int64_t>(min_poll_ms_)) {
+        return wait <= 0 ? 0 : min_poll_ms_;
+    }
+    if (wait > static_cast<int64_t>(max_poll_ms_)) {
+        return max_poll_ms_;
+    }
+
+    return static_cast<uint32_t>(wait);
+}
+
+int64_t PRedisDelayQueue::now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+int PRedisDelayQueue::load_script()
+{
+    args_.reset();
+    args_.push("SCRIPT", 6);
+    args_.push("LOAD", 4);
+    args_.push(s_claim_script, sizeof(s_claim_script) - 1);
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("SCRIPT LOAD error: reply is nullptr");
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_STRING) {
+        script_sha_.assign(reply->str, reply->len);
+        ret = 0;
+    } else {
+        pc_log_error("SCRIPT LOAD error: %s",
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_STRING");
+    }
+
+    return ret;
+}
+
+/*
+ * 服务端重启或 SCRIPT FLUSH 后脚本会丢失, 收到 NOSCRIPT 时重新加载再试一次
+ */
+int PRedisDelayQueue::eval_claim(size_t count, int64_t now, PRedisReply &reply)
+{
+    if (script_sha_.empty() && 0 != load_script()) {
+        return -1;
+    }
+
+    for (int retry = 0; retry < 2; ++retry) {
+        args_.reset();
+        args_.push("EVALSHA", 7);
+        args_.push(script_sha_);
+        args_.push("1", 1);
+        args_.push(key_);
+        args_.push(static_cast<long long>(now));
+        args_.push(static_cast<long long>(count));
+
+        reply = connection_.command(args_);
+        if (!reply) {
+            pc_log_error("EVALSHA claim %s error: reply is nullptr", key_.c_str());
+            return -1;
+        }
+        if (reply->type != REDIS_REPLY_ERROR || 0 != strncmp(reply->str, "NOSCRIPT", 8)) {
+            return 0;
+        }
+
+        reply.reset();
+        if (0 != load_script()) {
+            return -1;
+        }
+    }
+
+    pc_log_error("EVALSHA claim %s error: NOSCRIPT after reload", key_.c_str());
+    return -1;
+}
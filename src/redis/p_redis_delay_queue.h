@@ -0,0 +1,93 @@
+/*
+ * FileName : p_redis_delay_queue.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 06:14:45 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 基于 sorted set 的延时任务队列
+     *
+     * score 为任务到期的毫秒时间戳. claim() 通过一次 EVALSHA 在服务端
+     * 原子地取出并删除最多 N 个到期任务, 同时返回下一个任务的到期时间,
+     * 多个 worker 之间不会重复领取. next_poll_ms() 根据下一个到期时间
+     * 计算轮询间隔, 取代固定间隔轮询.
+     *
+     * 到期判断使用客户端时间, 各 worker 的时钟偏差会直接体现为延时误差.
+     */
+    class PRedisDelayQueue : public noncopyable
+    {
+        public:
+            PRedisDelayQueue(const std::string &host, int port, const std::string &key);
+            ~PRedisDelayQueue();
+
+            /*
+             * @brief 建立连接并加载脚本
+             * return 0 成功 -1 失败
+             */
+            int connect(uint32_t timeout_ms);
+
+            /*
+             * @brief 轮询间隔的上下限, 默认 [10ms, 1000ms]
+             * 上限决定了其他进程新加入的更早任务最多被延后多久
+             */
+            void set_poll_interval(uint32_t min_ms, uint32_t max_ms);
+
+            /*
+             * @brief ZADD key due_ms member
+             * return 1 新增 0 更新了已有任务的到期时间 -1 异常
+             */
+            int schedule(const std::string &member, int64_t due_ms);
+            int schedule(const std::vector< std::pair<int64_t, std::string> > &jobs);
+
+            /*
+             * @brief ZREM key member, 取消尚未被领取的任务
+             * return 1 成功 0 不存在 -1 异常
+             */
+            int cancel(const std::string &member);
+
+            /*
+             * @brief 原子地领取最多 count 个已到期的任务
+             * return >=0 领取的个数
+             *         -1 异常
+             */
+            int claim(size_t count, std::vector<std::string> &members);
+
+            /*
+             * @brief 距离下一次应该调用 claim() 的毫秒数
+             * 上一次领满了 count 个返回0; 否则按下一个任务的到期时间,
+             * 并限制在 set_poll_interval() 设定的范围内
+             */
+            uint32_t next_poll_ms() const;
+
+            static int64_t now_ms();
+
+        private:
+            int load_script();
+            int eval_claim(size_t count, int64_t now, PRedisReply &reply);
+
+            PRedisConnection connection_;
+            std::string      key_;
+            std::string      script_sha_;
+            PRedisArgv       args_;
+
+            uint32_t min_poll_ms_;
+            uint32_t max_poll_ms_;
+            bool     last_claim_full_;
+            int64_t  next_due_ms_;          /* -1 表示队列为空 */
+    };
+
+}
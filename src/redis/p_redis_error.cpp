@@ -0,0 +1,83 @@
+/*
+ * FileName : p_redis_error.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 22 Oct 2026 04:38:20 PM CST   Created
+*/
+
+#include "p_redis_error.h"
+
+#include <string.h>
+#include <time.h>
+
+using namespace pepper;
+
+const char *pepper::predis_error_name(PRedisError error)
+{
+    switch (error) {
+    case PREDIS_OK:                 return "ok";
+    case PREDIS_ERR_NOT_CONNECTED:  return "not connected";
+    case PREDIS_ERR_IO:             return "io error";
+    case PREDIS_ERR_REPLY:          return "error reply";
+    case PREDIS_ERR_TYPE:           return "unexpected reply";
+    case PREDIS_ERR_DECODE:         return "decode error";
+    case PREDIS_ERR_TIMEOUT:        return "deadline exceeded";
+    case PREDIS_ERR_CANCELLED:      return "cancelled";
+    case PREDIS_ERR_CIRCUIT_OPEN:   return "circuit open";
+    case PREDIS_ERR_OVERLOADED:     return "overloaded";
+    }
+
+    return "unknown";
+}
+
+/*
+ * 命令数量有限, 顺序查找; 同一个字符串常量先比较指针
+ */
+PRedisCommandCounters &PRedisCommandStats::get(const char *cmd)
+{
+    for (auto &counters : counters_) {
+        if (counters.command == cmd || 0 == strcmp(counters.command, cmd)) {
+            return counters;
+        }
+    }
+
+    PRedisCommandCounters counters = { cmd, 0, 0, 0, 0 };
+    counters_.push_back(counters);
+
+    return counters_.back();
+}
+
+void PRedisCommandStats::reset()
+{
+    for (auto &counters : counters_) {
+        counters.calls   = 0;
+        counters.errors  = 0;
+        counters.nils    = 0;
+        counters.retries = 0;
+    }
+}
+
+bool PRedisErrorLog::allow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+    if (ts.tv_sec != window_) {
+        window_ = ts.tv_sec;
+        logged_ = 0;
+    }
+    if (logged_ < limit_) {
+        ++logged_;
+        return true;
+    }
+    ++suppressed_;
+
+    return false;
+}
+
+uint64_t PRedisErrorLog::take_suppressed()
+{
+    uint64_t suppressed = suppressed_;
+    suppressed_ = 0;
+
+    return suppressed;
+}
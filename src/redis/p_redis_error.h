@@ -0,0 +1,85 @@
+/*
+ * FileName : p_redis_error.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 22 Oct 2026 04:38:20 PM CST   Created
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    enum PRedisError
+    {
+        PREDIS_OK = 0,
+        PREDIS_ERR_NOT_CONNECTED,       /* 没有连接 */
+        PREDIS_ERR_IO,                  /* 读写失败或超时, 连接已不可用 */
+        PREDIS_ERR_REPLY,               /* 服务端返回错误, 或状态回复不是 OK */
+        PREDIS_ERR_TYPE,                /* 回复的类型或结构与命令不符 */
+        PREDIS_ERR_DECODE,              /* 值解压或解码失败 */
+        PREDIS_ERR_TIMEOUT,             /* 超过截止时间, 回复稍后丢弃 */
+        PREDIS_ERR_CANCELLED,           /* 调用方取消, 回复稍后丢弃 */
+        PREDIS_ERR_CIRCUIT_OPEN,        /* 熔断打开, 没有发送 */
+        PREDIS_ERR_OVERLOADED           /* 超过并发上限被拒绝, 没有发送 */
+    };
+
+    const char *predis_error_name(PRedisError error);
+
+    /*
+     * @brief 每个命令的调用、错误和 NIL 回复次数
+     * NIL 不算错误 (例如 GET 未命中), 只计数不打日志
+     */
+    struct PRedisCommandCounters
+    {
+        const char *command;
+        uint64_t    calls;
+        uint64_t    errors;
+        uint64_t    nils;
+        uint64_t    retries;            /* IO 错误后按重试策略重发的次数 */
+    };
+
+    class PRedisCommandStats
+    {
+        public:
+            /* cmd 需要是字符串常量, 只保存指针 */
+            PRedisCommandCounters &get(const char *cmd);
+
+            const std::vector<PRedisCommandCounters> &counters() const { return counters_; }
+
+            void reset();
+
+        private:
+            std::vector<PRedisCommandCounters> counters_;
+    };
+
+    /*
+     * @brief 错误日志限流: 每秒最多输出 limit 条, 其余只计数,
+     * 下一条输出时带上被抑制的条数
+     */
+    class PRedisErrorLog
+    {
+        public:
+            explicit PRedisErrorLog(uint32_t limit_per_second = 10)
+                : limit_(limit_per_second), window_(0), logged_(0), suppressed_(0) {}
+
+            /* 0 表示不输出错误日志 */
+            void set_limit(uint32_t limit_per_second) { limit_ = limit_per_second; }
+
+            /* 允许输出返回 true, 否则计入被抑制的条数 */
+            bool allow();
+
+            /* 返回上次输出以来被抑制的条数并清零 */
+            uint64_t take_suppressed();
+
+        private:
+            uint32_t limit_;
+            int64_t  window_;
+            uint32_t logged_;
+            uint64_t suppressed_;
+    };
+
+}
@@ -0,0 +1,255 @@
+/*
+ * FileName : p_redis_hash_mapping.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 21 Oct 2026 03:27:05 PM CST   Created
+*/
+
+#pragma once
+
+#include "hiredis.h"
+#include "p_redis_codec.h"
+#include "p_redis_compressor.h"
+#include "p_redis_resp.h"
+#include "p_string_ref.h"
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <stddef.h>
+
+/*
+ * @brief 声明结构体与 redis hash 的对应关系, 在全局作用域使用:
+ *
+ *   struct User { int64_t id; std::string name; uint32_t age; };
+ *   PEPPER_REDIS_HASH(User, id, name, age)
+ *
+ *   client.hset("user:1", user);      HSET user:1 id .. name .. age ..
+ *   client.hmget("user:1", user);     HMGET user:1 id name age
+ *
+ * field 名即成员名, 成员类型需要有 PRedisCodec (整数, std::string,
+ * 可平凡复制的结构体, protobuf 消息), 最多 32 个成员.
+ * Type 需要写全名字空间, 例如 PEPPER_REDIS_HASH(app::User, ...).
+ */
+#define PEPPER_REDIS_HASH(Type, ...)                                            \
+    namespace pepper                                                            \
+    {                                                                           \
+        template <>                                                             \
+        struct PRedisHashMapping<Type>                                          \
+        {                                                                       \
+            static const bool   defined = true;                                 \
+            static const size_t size    = PEPPER_REDIS_NARGS(__VA_ARGS__);      \
+                                                                                \
+            static const char *const *names()                                   \
+            {                                                                   \
+                static const char *const n[] = {                                \
+                    PEPPER_REDIS_FOR_EACH(PEPPER_REDIS_HASH_NAME, __VA_ARGS__)  \
+                };                                                              \
+                return n;                                                       \
+            }                                                                   \
+                                                                                \
+            template <typename Obj, typename F>                                 \
+            static void visit(Obj &obj, F &f)                                   \
+            {                                                                   \
+                PEPPER_REDIS_FOR_EACH(PEPPER_REDIS_HASH_VISIT, __VA_ARGS__)     \
+            }                                                                   \
+        };                                                                      \
+    }
+
+#define PEPPER_REDIS_HASH_NAME(field)   #field,
+#define PEPPER_REDIS_HASH_VISIT(field)  f(obj.field);
+
+#define PEPPER_REDIS_NARGS(...) \
+    PEPPER_REDIS_NARGS_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
+                        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define PEPPER_REDIS_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+                            _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, \
+                            _31, _32, N, ...) N
+
+#define PEPPER_REDIS_CAT(a, b)  PEPPER_REDIS_CAT_(a, b)
+#define PEPPER_REDIS_CAT_(a, b) a##b
+
+#define PEPPER_REDIS_FOR_EACH(m, ...) \
+    PEPPER_REDIS_CAT(PEPPER_REDIS_FOR_EACH_, PEPPER_REDIS_NARGS(__VA_ARGS__))(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_1(m, x)      m(x)
+#define PEPPER_REDIS_FOR_EACH_2(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_1(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_3(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_2(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_4(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_3(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_5(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_4(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_6(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_5(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_7(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_6(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_8(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_7(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_9(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_8(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_10(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_9(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_11(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_10(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_12(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_11(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_13(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_12(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_14(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_13(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_15(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_14(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_16(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_15(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_17(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_16(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_18(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_17(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_19(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_18(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_20(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_19(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_21(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_20(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_22(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_21(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_23(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_22(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_24(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_23(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_25(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_24(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_26(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_25(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_27(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_26(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_28(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_27(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_29(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_28(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_30(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_29(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_31(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_30(m, __VA_ARGS__)
+#define PEPPER_REDIS_FOR_EACH_32(m, x, ...) m(x) PEPPER_REDIS_FOR_EACH_31(m, __VA_ARGS__)
+
+namespace pepper
+{
+
+    /*
+     * @brief 由 PEPPER_REDIS_HASH 特化, 未声明的类型 defined 为 false
+     */
+    template <typename T>
+    struct PRedisHashMapping
+    {
+        static const bool defined = false;
+    };
+
+    template <typename T, typename R = int>
+    using PRedisHashResult = typename std::enable_if<PRedisHashMapping<T>::defined, R>::type;
+
+    /*
+     * @brief 每个类型固定不变的命令片段, 第一次使用时生成一次:
+     * 命令头 (参数个数和命令名) 以及编码好的各个 field 参数,
+     * 之后每次调用只需要写 key 和各成员的值
+     */
+    template <typename T>
+    class PRedisHashLayout
+    {
+        public:
+            static const PRedisHashLayout &instance()
+            {
+                static const PRedisHashLayout layout;
+                return layout;
+            }
+
+            /* *<2+2n> HSET, 后面接 key 和 field/value */
+            const std::string &hset_prefix() const { return hset_prefix_; }
+
+            /* *<2+n> HMGET, 后面接 key 和 hmget_fields() */
+            const std::string &hmget_prefix() const { return hmget_prefix_; }
+            const std::string &hmget_fields() const { return fields_; }
+
+            PStringRef field_arg(size_t i) const
+            {
+                return PStringRef(fields_.data() + offsets_[i], offsets_[i+1] - offsets_[i]);
+            }
+
+        private:
+            PRedisHashLayout()
+            {
+                const size_t n = PRedisHashMapping<T>::size;
+
+                PRespWriter hset(hset_prefix_);
+                hset.begin(2 + 2 * n).arg("HSET", 4);
+
+                PRespWriter hmget(hmget_prefix_);
+                hmget.begin(2 + n).arg("HMGET", 5);
+
+                PRespWriter fields(fields_);
+                offsets_.push_back(0);
+                for (size_t i = 0; i < n; ++i) {
+                    fields.arg(PRedisHashMapping<T>::names()[i]);
+                    offsets_.push_back(fields_.size());
+                }
+            }
+
+            std::string         hset_prefix_;
+            std::string         hmget_prefix_;
+            std::string         fields_;
+            std::vector<size_t> offsets_;
+    };
+
+    /* 依次写入 field 参数和成员的值, compressor 不为空时值先编码到 buf 再压缩 */
+    template <typename T>
+    class PRedisHashEncoder
+    {
+        public:
+            PRedisHashEncoder(PRespWriter &writer, const PRedisHashLayout<T> &layout,
+                              PRedisCompressor *compressor, std::string &buf)
+                : writer_(writer), layout_(layout), compressor_(compressor), buf_(buf), index_(0),
+                  compress_failed_(false) {}
+
+            template <typename M>
+            void operator()(const M &member)
+            {
+                PStringRef field = layout_.field_arg(index_++);
+                writer_.raw(field.data(), field.size());
+
+                size_t len = PRedisCodec<M>::size(member);
+                if (compressor_ != nullptr) {
+                    buf_.resize(len);
+                    PRedisCodec<M>::encode(member, &buf_[0]);
+                    if (0 != compressor_->write_arg(writer_, buf_)) {
+                        compress_failed_ = true;
+                    }
+                    return;
+                }
+                PRedisCodec<M>::encode(member, writer_.arg_space(len));
+            }
+
+            /* 有成员压缩出错, 已按原值写入 */
+            bool compress_failed() const { return compress_failed_; }
+
+        private:
+            PRespWriter                 &writer_;
+            const PRedisHashLayout<T>   &layout_;
+            PRedisCompressor            *compressor_;
+            std::string                 &buf_;
+            size_t                       index_;
+            bool                         compress_failed_;
+    };
+
+    /* 按 field 顺序把 HMGET 的回复解码进成员, NIL 的成员保持原值 */
+    class PRedisHashDecoder
+    {
+        public:
+            PRedisHashDecoder(const redisReply *r, PRedisCompressor *compressor)
+                : reply_(r), compressor_(compressor), index_(0), found_(0), ok_(true),
+                  error_("cannot decode value") {}
+
+            template <typename M>
+            void operator()(M &member)
+            {
+                const redisReply *item = reply_->element[index_++];
+                if (!ok_ || item->type != REDIS_REPLY_STRING) {
+                    return;
+                }
+                PStringRef data(item->str, item->len);
+                if (compressor_ != nullptr && 0 != compressor_->read(data, data)) {
+                    ok_    = false;
+                    error_ = compressor_->error();
+                    return;
+                }
+                if (!PRedisCodec<M>::decode(data.data(), data.size(), member)) {
+                    ok_ = false;
+                    return;
+                }
+                ++found_;
+            }
+
+            bool ok() const { return ok_; }
+            int found() const { return found_; }
+            const char *error() const { return error_; }
+
+        private:
+            const redisReply *reply_;
+            PRedisCompressor *compressor_;
+            size_t            index_;
+            int               found_;
+            bool              ok_;
+            const char       *error_;
+    };
+
+}
@@ -0,0 +1,46 @@
+/*
+ * FileName : p_redis_health.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 29 Oct 2026 10:43:15 AM CST   Created
+*/
+
+#include "p_redis_health.h"
+#include "p_redis_latency.h"
+
+#include <algorithm>
+
+using namespace pepper;
+
+PRedisReconnectBudget::PRedisReconnectBudget(double per_second, double burst)
+    : per_second_(per_second), burst_(burst), tokens_(burst), last_us_(predis_now_us())
+{
+}
+
+bool PRedisReconnectBudget::take()
+{
+    uint64_t now = predis_now_us();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    tokens_ = std::min(burst_, tokens_ + per_second_ * static_cast<double>(now - last_us_) / 1e6);
+    last_us_ = now;
+    if (tokens_ < 1.0) {
+        return false;
+    }
+    tokens_ -= 1.0;
+
+    return true;
+}
+
+/*
+ * 退避时长取 [base/2, cap] 之间的随机值, 至少等 base/2, 避免失败后紧接着重试
+ */
+void PRedisReconnectSchedule::defer(uint64_t now_us, const PRedisHealthOptions &options)
+{
+    PRedisRetryPolicy policy;
+    policy.base_backoff_ms = options.reconnect_base_ms;
+    policy.max_backoff_ms  = options.reconnect_max_ms;
+
+    ++failures_;
+    uint32_t delay_ms = options.reconnect_base_ms / 2 + backoff_.delay_ms(policy, failures_);
+    next_us_ = now_us + delay_ms * 1000ULL;
+}
@@ -0,0 +1,72 @@
+/*
+ * FileName : p_redis_health.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Thu 29 Oct 2026 10:43:15 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_retry.h"
+
+#include <mutex>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisHealthOptions
+    {
+        uint32_t ping_idle_ms      = 30000;     /* 空闲超过该时长, health_check 发一次 PING */
+        uint32_t reconnect_base_ms = 100;       /* 重连间隔, 按失败次数指数增长并加抖动 */
+        uint32_t reconnect_max_ms  = 10000;
+
+        /* false: 只在 health_check 中重连, 连接出错后命令调用立即失败, 需要定时器驱动 health_check;
+         * true: 命令调用时若重连已到期, 由该调用阻塞重连一次, 适合没有定时器的场景 */
+        bool     lazy_reconnect    = false;
+    };
+
+    /*
+     * @brief 重连的令牌桶, 多个连接共享, 节点恢复时不会所有连接同时重连
+     * 线程安全
+     */
+    class PRedisReconnectBudget : public noncopyable
+    {
+        public:
+            PRedisReconnectBudget(double per_second, double burst);
+
+            bool take();
+
+        private:
+            std::mutex mutex_;
+            double     per_second_;
+            double     burst_;
+            double     tokens_;
+            uint64_t   last_us_;
+    };
+
+    /*
+     * @brief 一条连接的重连时间表
+     */
+    class PRedisReconnectSchedule
+    {
+        public:
+            PRedisReconnectSchedule() : next_us_(0), failures_(0) {}
+
+            bool due(uint64_t now_us) const { return now_us >= next_us_; }
+
+            /* 重连失败或没有拿到令牌, 按退避推迟下一次 */
+            void defer(uint64_t now_us, const PRedisHealthOptions &options);
+
+            void succeeded() { next_us_ = 0; failures_ = 0; }
+
+            uint32_t failures() const { return failures_; }
+
+        private:
+            uint64_t      next_us_;
+            uint32_t      failures_;
+            PRedisBackoff backoff_;
+    };
+
+}
@@ -0,0 +1,317 @@
+/*
+ * FileName : p_redis_hedged_reader.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 26 Oct 2026 03:12:08 PM CST   Created
+*/
+
+#include "p_redis_hedged_reader.h"
+
+#include <libpc/pc_logger.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+using namespace pepper;
+
+/* 一条连接积压的过期回复过多时说明该副本已经很慢, 直接断开重连 */
+static const uint32_t s_max_discard = 16;
+
+PRedisHedgeBudget::PRedisHedgeBudget(double ratio, double burst)
+    : ratio_(ratio), burst_(burst), tokens_(burst)
+{
+}
+
+void PRedisHedgeBudget::deposit()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    tokens_ = std::min(tokens_ + ratio_, burst_);
+}
+
+bool PRedisHedgeBudget::take()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tokens_ < 1.0) {
+        return false;
+    }
+    tokens_ -= 1.0;
+
+    return true;
+}
+
+PRedisHedgedReader::PRedisHedgedReader(const std::vector< std::pair<std::string, int> > &replicas,
+                                       const PRedisHedgeOptions &options)
+    : options_(options), next_(0),
+      budget_(std::make_shared<PRedisHedgeBudget>(options.budget_ratio, options.budget_burst)),
+      latency_(options.window)
+{
+    replicas_.reserve(replicas.size());
+    for (const auto &addr : replicas) {
+        Replica replica;
+        replica.conn.reset(new PRedisConnection(addr.first, addr.second));
+        replica.discard     = 0;
+        replica.retry_at_us = 0;
+        replicas_.push_back(std::move(replica));
+    }
+}
+
+int PRedisHedgedReader::connect(uint32_t timeout_ms)
+{
+    int connected = 0;
+    for (auto &replica : replicas_) {
+        replica.discard = 0;
+        if (0 == replica.conn->connect(timeout_ms)) {
+            ++connected;
+        } else {
+            replica.retry_at_us = predis_now_us() + options_.reconnect_interval_ms * 1000ULL;
+        }
+    }
+
+    return connected > 0 ? 0 : -1;
+}
+
+uint32_t PRedisHedgedReader::hedge_delay_us()
+{
+    uint32_t delay = latency_.percentile(options_.percentile);
+    if (0 == delay) {
+        delay = options_.initial_delay_us;
+    }
+
+    return std::min(std::max(delay, options_.min_delay_us), options_.max_delay_us);
+}
+
+void PRedisHedgedReader::set_endpoint(size_t replica,
+                                      const std::shared_ptr<PRedisEndpoint> &endpoint)
+{
+    if (replica < replicas_.size()) {
+        replicas_[replica].conn->set_endpoint(endpoint);
+    }
+}
+
+void PRedisHedgedReader::set_budget(const std::shared_ptr<PRedisHedgeBudget> &budget)
+{
+    if (budget) {
+        budget_ = budget;
+    }
+}
+
+PRedisReply PRedisHedgedReader::command(PRedisArgv &args)
+{
+    ++stats_.requests;
+    budget_->deposit();
+
+    PRedisReply reply;
+    for (uint32_t attempt = 1; ; ++attempt) {
+        if (0 == command_once(args, reply)) {
+            return reply;
+        }
+        if (attempt >= options_.retry.max_attempts) {
+            break;
+        }
+        ++stats_.retries;
+        PRedisBackoff::sleep_ms(backoff_.delay_ms(options_.retry, attempt));
+    }
+    ++stats_.failures;
+
+    return PRedisReply();
+}
+
+int PRedisHedgedReader::command_once(PRedisArgv &args, PRedisReply &reply)
+{
+    int ids[2] = { pick(-1), -1 };
+    if (ids[0] < 0 || 0 != send(ids[0], args)) {
+        return -1;
+    }
+    size_t n = 1;
+
+    uint64_t start    = predis_now_us();
+    uint64_t deadline = start + options_.timeout_ms * 1000ULL;
+    int winner = wait_reply(ids, n, std::min(start + hedge_delay_us(), deadline), reply);
+    if (winner == -1) {
+        int backup = pick(ids[0]);
+        if (backup >= 0 && !budget_->take()) {
+            ++stats_.budget_exhausted;
+        } else if (backup >= 0 && 0 == send(backup, args)) {
+            ids[n++] = backup;
+            ++stats_.hedged;
+        }
+        winner = wait_reply(ids, n, deadline, reply);
+    }
+
+    if (winner < 0) {
+        /* 超时的连接上还有未返回的请求, 断开比等着丢弃更可靠 */
+        for (size_t i = 0; i < n; ++i) {
+            if (replicas_[ids[i]].conn->connected()) {
+                pc_log_error("hedged read %s:%d error: timeout",
+                             replicas_[ids[i]].conn->host().c_str(), replicas_[ids[i]].conn->port());
+                replicas_[ids[i]].conn->close();
+            }
+        }
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        Replica &loser = replicas_[ids[i]];
+        if (ids[i] != winner && loser.conn->connected() && ++loser.discard > s_max_discard) {
+            loser.conn->close();
+        }
+    }
+    if (winner != ids[0]) {
+        ++stats_.hedge_wins;
+    }
+    latency_.add(static_cast<uint32_t>(std::min<uint64_t>(predis_now_us() - start, UINT32_MAX)));
+
+    return 0;
+}
+
+bool PRedisHedgedReader::available(int id, uint64_t now)
+{
+    Replica &replica = replicas_[id];
+    if (replica.conn->connected()) {
+        if (replica.discard > 0) {
+            drain(id);
+        }
+        return replica.conn->connected();
+    }
+    if (now < replica.retry_at_us) {
+        return false;
+    }
+
+    replica.discard = 0;
+    if (0 != replica.conn->ensure_connected()) {
+        replica.retry_at_us = now + options_.reconnect_interval_ms * 1000ULL;
+        return false;
+    }
+
+    return true;
+}
+
+int PRedisHedgedReader::pick(int exclude)
+{
+    uint64_t now = predis_now_us();
+    int fallback = -1;
+    for (size_t i = 0; i < replicas_.size(); ++i) {
+        int id = static_cast<int>((next_ + i) % replicas_.size());
+        if (id == exclude || !available(id, now)) {
+            continue;
+        }
+        if (0 == replicas_[id].discard) {
+            next_ = static_cast<size_t>(id) + 1;
+            return id;
+        }
+        if (fallback < 0) {
+            fallback = id;
+        }
+    }
+    if (fallback >= 0) {
+        next_ = static_cast<size_t>(fallback) + 1;
+    }
+
+    return fallback;
+}
+
+void PRedisHedgedReader::drain(int id)
+{
+    Replica &replica = replicas_[id];
+
+    struct pollfd pfd;
+    pfd.fd      = replica.conn->fd();
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    bool readable = poll(&pfd, 1, 0) > 0;
+
+    PRedisReply reply;
+    while (replica.discard > 0 && replica.conn->poll_reply(reply, readable) > 0) {
+        --replica.discard;
+        reply.reset();
+        readable = false;
+    }
+}
+
+int PRedisHedgedReader::send(int id, PRedisArgv &args)
+{
+    PRedisConnection &conn = *replicas_[id].conn;
+    if (0 != conn.append(args) || 0 != conn.flush()) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int PRedisHedgedReader::take_reply(int id, bool readable, PRedisReply &reply)
+{
+    Replica &replica = replicas_[id];
+    for (;;) {
+        int ret = replica.conn->poll_reply(reply, readable);
+        if (ret <= 0) {
+            return ret;
+        }
+        if (0 == replica.discard) {
+            return 1;
+        }
+        --replica.discard;
+        reply.reset();
+        readable = false;
+    }
+}
+
+int PRedisHedgedReader::wait_reply(const int *ids, size_t n, uint64_t deadline_us, PRedisReply &reply)
+{
+    struct pollfd fds[2];
+    int live[2];
+    size_t nlive = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        int ret = take_reply(ids[i], false, reply);
+        if (ret > 0) {
+            return ids[i];
+        }
+        if (ret == 0) {
+            live[nlive++] = ids[i];
+        }
+    }
+
+    while (nlive > 0) {
+        uint64_t now = predis_now_us();
+        if (now >= deadline_us) {
+            return -1;
+        }
+
+        for (size_t i = 0; i < nlive; ++i) {
+            fds[i].fd      = replicas_[live[i]].conn->fd();
+            fds[i].events  = POLLIN;
+            fds[i].revents = 0;
+        }
+        uint64_t wait_us = deadline_us - now;
+        struct timespec ts;
+        ts.tv_sec  = static_cast<time_t>(wait_us / 1000000);
+        ts.tv_nsec = static_cast<long>(wait_us % 1000000) * 1000L;
+        int ready = ppoll(fds, nlive, &ts, nullptr);
+        if (ready < 0 && errno != EINTR) {
+            pc_log_error("hedged read error: poll %d", errno);
+            return -2;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < nlive; ++i) {
+            int ret = 0;
+            if (fds[i].revents != 0) {
+                ret = take_reply(live[i], true, reply);
+            }
+            if (ret > 0) {
+                return live[i];
+            }
+            if (ret == 0) {
+                live[kept++] = live[i];
+            }
+        }
+        nlive = kept;
+    }
+
+    return -2;
+}
@@ -0,0 +1,157 @@
+/*
+ * FileName : p_redis_hedged_reader.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 26 Oct 2026 03:12:08 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+#include "p_redis_latency.h"
+#include "p_redis_reply.h"
+#include "p_redis_retry.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisHedgeOptions
+    {
+        /* 等待超过最近延迟的该分位数仍无回复时, 向另一个副本发出对冲请求 */
+        double   percentile           = 0.95;
+        uint32_t min_delay_us         = 500;
+        uint32_t max_delay_us         = 50000;
+        uint32_t initial_delay_us     = 5000;   /* 样本不足时使用 */
+        uint32_t window               = 1024;   /* 参与统计的最近延迟样本数 */
+
+        /* 对冲预算: 每个请求积累 budget_ratio 个令牌, 最多 budget_burst 个,
+         * 每次对冲消耗一个, 对冲请求不会超过总请求的 budget_ratio.
+         * 默认每个 PRedisHedgedReader 一份, 用 set_budget 在多个读者间共享 */
+        double   budget_ratio         = 0.05;
+        double   budget_burst         = 10;
+
+        uint32_t timeout_ms           = 1000;   /* 一次请求等待回复的上限 */
+        uint32_t reconnect_interval_ms = 1000;  /* 连接失败的副本多久后再试 */
+
+        PRedisRetryPolicy retry;                /* 所有副本都失败后的整体重试 */
+    };
+
+    struct PRedisHedgeStats
+    {
+        uint64_t requests         = 0;
+        uint64_t hedged           = 0;      /* 发出了对冲请求 */
+        uint64_t hedge_wins       = 0;      /* 对冲请求先返回 */
+        uint64_t budget_exhausted = 0;      /* 需要对冲但预算不足 */
+        uint64_t retries          = 0;
+        uint64_t failures         = 0;
+    };
+
+    /*
+     * @brief 对冲请求的令牌桶, 多个 PRedisHedgedReader 共享时限制全局的对冲比例,
+     * 每个线程或协程一个读者时对冲总量不会随读者个数增长. 线程安全
+     */
+    class PRedisHedgeBudget : public noncopyable
+    {
+        public:
+            PRedisHedgeBudget(double ratio, double burst);
+
+            /* 每个请求调用一次, 积累 ratio 个令牌 */
+            void deposit();
+
+            bool take();
+
+        private:
+            std::mutex mutex_;
+            double     ratio_;
+            double     burst_;
+            double     tokens_;
+    };
+
+    /*
+     * @brief 对冲读: 多个副本上的只读命令
+     *
+     * 请求轮流发往各副本, 超过延迟分位数仍无回复时把同一请求发往另一个
+     * 副本, 取先到的回复; 落后的回复在该连接下次读取时丢弃. 对冲数量受
+     * 预算限制, 副本整体变慢时不会把负载放大. 所有副本都失败后按
+     * options.retry 退避重试.
+     *
+     * 命令会在多个副本上执行, 只能用于只读命令. 非线程安全.
+     */
+    class PRedisHedgedReader : public noncopyable
+    {
+        public:
+            PRedisHedgedReader(const std::vector< std::pair<std::string, int> > &replicas,
+                               const PRedisHedgeOptions &options = PRedisHedgeOptions());
+
+            /*
+             * @brief 连接所有副本, 至少一个成功即可
+             * return 0 成功 -1 全部失败
+             */
+            int connect(uint32_t timeout_ms);
+
+            /*
+             * return 回复 (可能是错误回复), 超时或所有副本失败返回空的 PRedisReply
+             */
+            PRedisReply command(PRedisArgv &args);
+
+            /* 当前的对冲延迟 */
+            uint32_t hedge_delay_us();
+
+            /*
+             * @brief 第 replica 个副本跟随 endpoint 的地址, 地址变化后在该副本的
+             * 过期回复读完、下一次发送前切换
+             */
+            void set_endpoint(size_t replica, const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /* 替换默认的预算, 传入同一个 budget 的读者共享对冲额度 */
+            void set_budget(const std::shared_ptr<PRedisHedgeBudget> &budget);
+
+            const PRedisHedgeStats &stats() const { return stats_; }
+
+        private:
+            struct Replica
+            {
+                std::unique_ptr<PRedisConnection> conn;
+                uint32_t discard;           /* 待丢弃的过期回复数 */
+                uint64_t retry_at_us;       /* 连接失败后, 此前不再尝试 */
+            };
+
+            /* return 0 成功 -1 失败 */
+            int command_once(PRedisArgv &args, PRedisReply &reply);
+
+            /* 选一个可用副本, 优先没有待丢弃回复的; return 下标, -1 没有 */
+            int pick(int exclude);
+            bool available(int id, uint64_t now);
+
+            /* 不阻塞地丢弃已经到达的过期回复 */
+            void drain(int id);
+
+            int send(int id, PRedisArgv &args);
+
+            /*
+             * @brief 等待 ids 中任一副本的回复直到 deadline_us
+             * return 回复所在副本下标  -1 超时  -2 全部连接失败
+             */
+            int wait_reply(const int *ids, size_t n, uint64_t deadline_us, PRedisReply &reply);
+
+            /* return 1 取到本次的回复  0 没有  -1 连接失败 */
+            int take_reply(int id, bool readable, PRedisReply &reply);
+
+            PRedisHedgeOptions   options_;
+            std::vector<Replica> replicas_;
+            size_t               next_;
+            std::shared_ptr<PRedisHedgeBudget> budget_;
+            PRedisLatencyWindow  latency_;
+            PRedisBackoff        backoff_;
+            PRedisHedgeStats     stats_;
+    };
+
+}
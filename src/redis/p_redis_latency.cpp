@@ -0,0 +1,59 @@
+/*
+ * FileName : p_redis_latency.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 27 Oct 2026 02:36:51 PM CST   Created
+*/
+
+#include "p_redis_latency.h"
+
+#include <algorithm>
+
+#include <time.h>
+
+using namespace pepper;
+
+uint64_t pepper::predis_now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+}
+
+PRedisLatencyWindow::PRedisLatencyWindow(uint32_t window)
+    : samples_(window > 0 ? window : 1), next_(0), count_(0),
+      since_update_(0), cached_p_(-1), cached_(0)
+{
+    scratch_.reserve(samples_.size());
+}
+
+void PRedisLatencyWindow::add(uint32_t latency_us)
+{
+    samples_[next_] = latency_us;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size()) {
+        ++count_;
+    }
+    ++since_update_;
+}
+
+uint32_t PRedisLatencyWindow::percentile(double p)
+{
+    size_t min_samples = std::max<size_t>(samples_.size() / 16, 1);
+    if (count_ < min_samples) {
+        return 0;
+    }
+    if (p == cached_p_ && since_update_ < min_samples) {
+        return cached_;
+    }
+
+    scratch_.assign(samples_.begin(), samples_.begin() + count_);
+    size_t k = static_cast<size_t>(p * static_cast<double>(count_ - 1));
+    std::nth_element(scratch_.begin(), scratch_.begin() + k, scratch_.end());
+
+    cached_p_     = p;
+    cached_       = scratch_[k];
+    since_update_ = 0;
+
+    return cached_;
+}
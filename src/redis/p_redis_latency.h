@@ -0,0 +1,43 @@
+/*
+ * FileName : p_redis_latency.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 27 Oct 2026 02:36:51 PM CST   Created
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /* CLOCK_MONOTONIC 微秒 */
+    uint64_t predis_now_us();
+
+    /*
+     * @brief 最近 window 个延迟样本的分位数, 每新增 window/16 个样本重算一次
+     */
+    class PRedisLatencyWindow
+    {
+        public:
+            explicit PRedisLatencyWindow(uint32_t window);
+
+            void add(uint32_t latency_us);
+
+            /* 样本不足 window/16 个时返回 0 */
+            uint32_t percentile(double p);
+
+        private:
+            std::vector<uint32_t> samples_;
+            std::vector<uint32_t> scratch_;
+            size_t                next_;
+            size_t                count_;
+            size_t                since_update_;
+            double                cached_p_;
+            uint32_t              cached_;
+    };
+
+}
@@ -0,0 +1,351 @@
+/*
+ * FileName : p_redis_list_queue.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 05:31:07 PM CST   Created
+*/
+
+#include "p_redis_list_queue.h"
+
+#include <libpc/pc_logger.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace pepper;
+
+PRedisListQueue::PRedisListQueue(const std::string &host, int port,
+        const std::string &key, const std::string &processing_key)
+    : connection_(host, port), blocking_connection_(host, port),
+      key_(key), processing_key_(processing_key)
+{
+}
+
+PRedisListQueue::~PRedisListQueue()
+{
+}
+
+int PRedisListQueue::connect(uint32_t timeout_ms)
+{
+    if (0 != connection_.connect(timeout_ms)) {
+        return -1;
+    }
+
+    return blocking_connection_.connect(timeout_ms);
+}
+
+void PRedisListQueue::set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint)
+{
+    connection_.set_endpoint(endpoint);
+    blocking_connection_.set_endpoint(endpoint);
+}
+
+int PRedisListQueue::push(const std::string &value)
+{
+    return push(std::vector<std::string>(1, value));
+}
+
+int PRedisListQueue::push(const std::vector<std::string> &values)
+{
+    if (values.empty()) { return size(); }
+
+    args_.reset();
+    args_.push("LPUSH", 5);
+    args_.push(key_);
+    for (const auto &value : values) {
+        args_.push(value);
+    }
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("LPUSH %s error: reply is nullptr", key_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_INTEGER) {
+        ret = static_cast<int>(reply->integer);
+    } else {
+        pc_log_error("LPUSH %s error: %s", key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+    }
+
+    return ret;
+}
+
+int PRedisListQueue::pop(size_t count, std::vector<std::string> &values)
+{
+    args_.reset();
+    args_.push("RPOP", 4);
+    args_.push(key_);
+    args_.push(static_cast<long long>(count));
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("RPOP %s %zu error: reply is nullptr", key_.c_str(), count);
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_NIL) {
+        ret = 0;
+    } else if (reply->type == REDIS_REPLY_ARRAY) {
+        values.reserve(values.size() + reply->elements);
+        for (size_t i = 0; i < reply->elements; ++i) {
+            values.emplace_back(reply->element[i]->str, reply->element[i]->len);
+        }
+        ret = static_cast<int>(reply->elements);
+    } else {
+        pc_log_error("RPOP %s %zu error: %s", key_.c_str(), count,
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_ARRAY");
+    }
+
+    return ret;
+}
+
+int PRedisListQueue::take(size_t count, int block_ms, std::vector<std::string> &values)
+{
+    if (count == 0) { return 0; }
+
+    int ret = move_batch(count, values);
+    if (ret != 0 || block_ms < 0) {
+        return ret;
+    }
+
+    /* 队列为空: 在阻塞连接上等第一个元素, 到达后再批量取剩下的 */
+    ret = block_move(block_ms, values);
+    if (ret <= 0 || count == 1) {
+        return ret;
+    }
+
+    int more = move_batch(count - 1, values);
+    return more > 0 ? ret + more : ret;
+}
+
+/*
+ * 没有带 count 的 LMOVE, 用脚本在服务端原子地 RPOP count 再推入目标列表;
+ * 一次往返, 命令数与队列长度无关. 需要 redis 6.2 (RPOP count), 与 LMOVE 相同.
+ * KEYS[1] 源列表, KEYS[2] 目标列表, ARGV[1] 最多移动的个数, ARGV[2] LPUSH/RPUSH
+ * 源列表右端的元素最早, LPUSH 按 RPOP 的顺序推入, 最早的在最右;
+ * RPUSH 倒序推入, 最早的同样在最右, 放回队列后最先被取出
+ */
+static const char s_move_script[] =
+    "local items = redis.call('RPOP', KEYS[1], ARGV[1])\n"
+    "if not items then return {} end\n"
+    "if ARGV[2] == 'RPUSH' then\n"
+    "    local n = #items\n"
+    "    for i = 1, math.floor(n / 2) do\n"
+    "        items[i], items[n + 1 - i] = items[n + 1 - i], items[i]\n"
+    "    end\n"
+    "end\n"
+    "for i = 1, #items, 1000 do\n"
+    "    redis.call(ARGV[2], KEYS[2], unpack(items, i, math.min(i + 999, #items)))\n"
+    "end\n"
+    "return items\n";
+
+int PRedisListQueue::move_batch(size_t count, std::vector<std::string> &values)
+{
+    PRedisReply reply;
+    if (0 != eval_move(key_, processing_key_, count, "LPUSH", reply)) {
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_ARRAY) {
+        values.reserve(values.size() + reply->elements);
+        for (size_t i = 0; i < reply->elements; ++i) {
+            values.emplace_back(reply->element[i]->str, reply->element[i]->len);
+        }
+        ret = static_cast<int>(reply->elements);
+    } else {
+        pc_log_error("EVALSHA move %s %s error: %s", key_.c_str(), processing_key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_ARRAY");
+    }
+
+    return ret;
+}
+
+int PRedisListQueue::load_script()
+{
+    args_.reset();
+    args_.push("SCRIPT", 6);
+    args_.push("LOAD", 4);
+    args_.push(s_move_script, sizeof(s_move_script) - 1);
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("SCRIPT LOAD error: reply is nullptr");
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_STRING) {
+        script_sha_.assign(reply->str, reply->len);
+        ret = 0;
+    } else {
+        pc_log_error("SCRIPT LOAD error: %s",
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_STRING");
+    }
+
+    return ret;
+}
+
+/*
+ * 服务端重启或 SCRIPT FLUSH 后脚本会丢失, 收到 NOSCRIPT 时重新加载再试一次
+ */
+int PRedisListQueue::eval_move(const std::string &src, const std::string &dst, size_t count,
+                               const char *push, PRedisReply &reply)
+{
+    if (script_sha_.empty() && 0 != load_script()) {
+        return -1;
+    }
+
+    for (int retry = 0; retry < 2; ++retry) {
+        args_.reset();
+        args_.push("EVALSHA", 7);
+        args_.push(script_sha_);
+        args_.push("2", 1);
+        args_.push(src);
+        args_.push(dst);
+        args_.push(static_cast<long long>(count));
+        args_.push(push, strlen(push));
+
+        reply = connection_.command(args_);
+        if (!reply) {
+            pc_log_error("EVALSHA move %s %s error: reply is nullptr", src.c_str(), dst.c_str());
+            return -1;
+        }
+        if (reply->type != REDIS_REPLY_ERROR || 0 != strncmp(reply->str, "NOSCRIPT", 8)) {
+            return 0;
+        }
+
+        reply.reset();
+        if (0 != load_script()) {
+            return -1;
+        }
+    }
+
+    pc_log_error("EVALSHA move %s %s error: NOSCRIPT after reload", src.c_str(), dst.c_str());
+    return -1;
+}
+
+int PRedisListQueue::block_move(int block_ms, std::vector<std::string> &values)
+{
+    if (0 != blocking_connection_.set_block_timeout(block_ms)) {
+        return -1;
+    }
+
+    char timeout_str[24];
+    int timeout_len = snprintf(timeout_str, sizeof(timeout_str), "%d.%03d",
+                               block_ms / 1000, block_ms % 1000);
+
+    args_.reset();
+    args_.push("BLMOVE", 6);
+    args_.push(key_);
+    args_.push(processing_key_);
+    args_.push("RIGHT", 5);
+    args_.push("LEFT", 4);
+    args_.push(timeout_str, static_cast<size_t>(timeout_len));
+
+    PRedisReply reply = blocking_connection_.command(args_);
+    if (!reply) {
+        pc_log_error("BLMOVE %s %s error: reply is nullptr", key_.c_str(), processing_key_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_NIL) {
+        ret = 0;
+    } else if (reply->type == REDIS_REPLY_STRING) {
+        values.emplace_back(reply->str, reply->len);
+        ret = 1;
+    } else {
+        pc_log_error("BLMOVE %s %s error: %s", key_.c_str(), processing_key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_STRING");
+    }
+
+    return ret;
+}
+
+int PRedisListQueue::ack(const std::string &value)
+{
+    return ack(std::vector<std::string>(1, value));
+}
+
+/*
+ * take() 从左端放入 processing 列表, 越早取出的越靠右,
+ * 所以 LREM 用 -1 从右往左找, 按顺序确认时几乎不用扫描.
+ */
+int PRedisListQueue::ack(const std::vector<std::string> &values)
+{
+    for (const auto &value : values) {
+        args_.reset();
+        args_.push("LREM", 4);
+        args_.push(processing_key_);
+        args_.push("-1", 2);
+        args_.push(value);
+        if (0 != connection_.append(args_)) {
+            pc_log_error("LREM %s error: append failed", processing_key_.c_str());
+            return -1;
+        }
+    }
+
+    int removed = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        PRedisReply reply;
+        if (0 != connection_.read_reply(reply)) {
+            pc_log_error("LREM %s error: reply is nullptr", processing_key_.c_str());
+            return -1;
+        }
+        if (reply->type == REDIS_REPLY_INTEGER) {
+            removed += static_cast<int>(reply->integer);
+        } else {
+            pc_log_error("LREM %s error: %s", processing_key_.c_str(),
+                         reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+        }
+    }
+
+    return removed;
+}
+
+int PRedisListQueue::requeue(size_t count)
+{
+    if (count == 0) { return 0; }
+
+    PRedisReply reply;
+    if (0 != eval_move(processing_key_, key_, count, "RPUSH", reply)) {
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_ARRAY) {
+        ret = static_cast<int>(reply->elements);
+    } else {
+        pc_log_error("EVALSHA move %s %s error: %s", processing_key_.c_str(), key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_ARRAY");
+    }
+
+    return ret;
+}
+
+int PRedisListQueue::size()
+{
+    args_.reset();
+    args_.push("LLEN", 4);
+    args_.push(key_);
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("LLEN %s error: reply is nullptr", key_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_INTEGER) {
+        ret = static_cast<int>(reply->integer);
+    } else {
+        pc_log_error("LLEN %s error: %s", key_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+    }
+
+    return ret;
+}
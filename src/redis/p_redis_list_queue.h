@@ -0,0 +1,104 @@
+/*
+ * FileName : p_redis_list_queue.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 05:31:07 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 基于 list 的批量工作队列
+     *
+     * 生产者 LPUSH 到 key, 消费者从右端取出:
+     *   pop()  LPOP/RPOP count, 一次往返取多个元素, 至多一次投递
+     *   take() 把元素移到 processing 列表后再返回, 处理完调用 ack()
+     *          删除, 进程崩溃后用 requeue() 放回队列, 至少一次投递
+     *
+     * 批量移动由一个 lua 脚本 (RPOP count + LPUSH) 在服务端原子完成, 一次往返;
+     * ack 的多条 LREM 在命令连接上用 pipeline 一次写出; 阻塞等待(BLMOVE)使用
+     * 单独的阻塞连接, 只挂起调用的协程, 不占用命令连接. 需要 redis 6.2. 非线程安全.
+     */
+    class PRedisListQueue : public noncopyable
+    {
+        public:
+            PRedisListQueue(const std::string &host, int port,
+                            const std::string &key, const std::string &processing_key);
+            ~PRedisListQueue();
+
+            /*
+             * @brief 建立命令连接和阻塞连接, 之后连接异常会在下一次调用时自动重连
+             * return 0 成功 -1 失败
+             */
+            int connect(uint32_t timeout_ms);
+
+            /* 命令连接和阻塞连接都跟随 endpoint 的地址 (一般来自 PRedisSentinel) */
+            void set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /*
+             * @brief 一条 LPUSH 写入多个元素
+             * return 队列长度 -1 异常
+             */
+            int push(const std::string &value);
+            int push(const std::vector<std::string> &values);
+
+            /*
+             * @brief RPOP key count, 不进入 processing 列表
+             * return 取出的个数 -1 异常
+             */
+            int pop(size_t count, std::vector<std::string> &values);
+
+            /*
+             * @brief 最多取出 count 个元素并放入 processing 列表
+             * @param block_ms 队列为空时: <0 立即返回, 0 一直等待, >0 最多等待的毫秒数
+             * return 取出的个数(超时返回0)
+             *        -1 异常
+             */
+            int take(size_t count, int block_ms, std::vector<std::string> &values);
+
+            /*
+             * @brief 从 processing 列表删除已处理的元素, 多条 LREM 一次写出
+             * return 删除的个数 -1 异常
+             */
+            int ack(const std::string &value);
+            int ack(const std::vector<std::string> &values);
+
+            /*
+             * @brief 把 processing 列表中最早取出的最多 count 个元素放回队列右端,
+             * 按原来的先后顺序优先被取出
+             * 只应在确认没有消费者持有这些元素时调用, 例如启动时
+             * return 放回的个数 -1 异常
+             */
+            int requeue(size_t count);
+
+            /*
+             * return 队列长度 -1 异常
+             */
+            int size();
+
+        private:
+            int move_batch(size_t count, std::vector<std::string> &values);
+            int block_move(int block_ms, std::vector<std::string> &values);
+            int load_script();
+            int eval_move(const std::string &src, const std::string &dst, size_t count,
+                          const char *push, PRedisReply &reply);
+
+            PRedisConnection connection_;
+            PRedisConnection blocking_connection_;
+            std::string      key_;
+            std::string      processing_key_;
+            std::string      script_sha_;
+            PRedisArgv       args_;
+    };
+
+}
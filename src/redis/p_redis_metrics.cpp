@@ -0,0 +1,244 @@
+/*
+ * FileName : p_redis_metrics.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 02 Nov 2026 10:18:36 AM CST   Created
+*/
+
+#include "p_redis_metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace pepper;
+
+/* 导出 Prometheus 直方图使用的边界, 单位微秒 */
+static const uint64_t s_export_bounds_us[] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+};
+
+void PRedisMetricsSnapshot::merge(const PRedisEndpointMetricsSnapshot &endpoint)
+{
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        if (endpoints[i].endpoint == endpoint.endpoint) {
+            endpoints[i].reconnects += endpoint.reconnects;
+            return;
+        }
+    }
+    endpoints.push_back(endpoint);
+}
+
+static void append_label(std::string &out, const std::string &value)
+{
+    for (size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+}
+
+static void append_series(std::string &out, const char *name, const PRedisCommandMetricsSnapshot &m,
+                          const char *le, uint64_t value)
+{
+    char num[32];
+    out += name;
+    out += "{command=\"";
+    append_label(out, m.command);
+    out += "\",endpoint=\"";
+    append_label(out, m.endpoint);
+    out += '"';
+    if (le != nullptr) {
+        out += ",le=\"";
+        out += le;
+        out += '"';
+    }
+    snprintf(num, sizeof(num), "} %llu\n", static_cast<unsigned long long>(value));
+    out += num;
+}
+
+static void append_counter(std::string &out, const char *name, const char *help,
+                           const std::vector<PRedisCommandMetricsSnapshot> &commands,
+                           uint64_t PRedisCommandMetricsSnapshot::*field)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " counter\n";
+    for (size_t i = 0; i < commands.size(); ++i) {
+        append_series(out, name, commands[i], nullptr, commands[i].*field);
+    }
+}
+
+void PRedisMetricsSnapshot::export_prometheus(std::string &out) const
+{
+    static const char *name = "predis_command_duration_seconds";
+    char buf[64];
+
+    out += "# HELP predis_command_duration_seconds Redis command latency, including retries.\n";
+    out += "# TYPE predis_command_duration_seconds histogram\n";
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const PRedisCommandMetricsSnapshot &m = commands[i];
+        const PRedisHistogramSnapshot &h = m.latency;
+
+        /* 直方图的格与导出边界不对齐, 格的上界不超过边界时才计入 */
+        uint64_t cumulative = 0;
+        int b = 0;
+        for (size_t j = 0; j < sizeof(s_export_bounds_us) / sizeof(s_export_bounds_us[0]); ++j) {
+            while (b < PRedisHistogramSnapshot::kBuckets
+                    && PRedisHistogramSnapshot::upper_bound(b) <= s_export_bounds_us[j]) {
+                cumulative += h.bucket(b++);
+            }
+            snprintf(buf, sizeof(buf), "%g", static_cast<double>(s_export_bounds_us[j]) / 1e6);
+            append_series(out, "predis_command_duration_seconds_bucket", m, buf, cumulative);
+        }
+        append_series(out, "predis_command_duration_seconds_bucket", m, "+Inf", h.count());
+
+        out += name;
+        out += "_sum{command=\"";
+        append_label(out, m.command);
+        out += "\",endpoint=\"";
+        append_label(out, m.endpoint);
+        snprintf(buf, sizeof(buf), "\"} %.6f\n", static_cast<double>(h.sum()) / 1e6);
+        out += buf;
+        append_series(out, "predis_command_duration_seconds_count", m, nullptr, h.count());
+    }
+
+    append_counter(out, "predis_commands_total", "Redis commands executed.",
+                   commands, &PRedisCommandMetricsSnapshot::ops);
+    append_counter(out, "predis_command_errors_total", "Redis commands that failed.",
+                   commands, &PRedisCommandMetricsSnapshot::errors);
+    append_counter(out, "predis_command_nils_total", "Redis commands that returned nil.",
+                   commands, &PRedisCommandMetricsSnapshot::nils);
+    append_counter(out, "predis_bytes_sent_total", "Bytes written to the socket.",
+                   commands, &PRedisCommandMetricsSnapshot::bytes_sent);
+    append_counter(out, "predis_bytes_received_total", "Bytes read from the socket.",
+                   commands, &PRedisCommandMetricsSnapshot::bytes_received);
+
+    out += "# HELP predis_reconnects_total Reconnects to the endpoint.\n";
+    out += "# TYPE predis_reconnects_total counter\n";
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        out += "predis_reconnects_total{endpoint=\"";
+        append_label(out, endpoints[i].endpoint);
+        snprintf(buf, sizeof(buf), "\"} %llu\n", static_cast<unsigned long long>(endpoints[i].reconnects));
+        out += buf;
+    }
+}
+
+PRedisMetrics::PRedisMetrics()
+{
+    PRedisMetricsRegistry::instance().add(this);
+}
+
+PRedisMetrics::~PRedisMetrics()
+{
+    PRedisMetricsRegistry::instance().remove(this);
+}
+
+PRedisMetrics::Endpoint *PRedisMetrics::endpoint(const std::string &name)
+{
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        if (endpoints_[i]->name == name) {
+            return endpoints_[i].get();
+        }
+    }
+
+    std::unique_ptr<Endpoint> endpoint(new Endpoint());
+    endpoint->name = name;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoints_.push_back(std::move(endpoint));
+    return endpoints_.back().get();
+}
+
+PRedisCommandMetrics &PRedisMetrics::command(Endpoint *endpoint, const char *cmd)
+{
+    std::vector< std::pair<const char *, PRedisCommandMetrics *> > &index = endpoint->index;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index[i].first == cmd) {
+            return *index[i].second;
+        }
+    }
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (0 == strcmp(index[i].first, cmd)) {
+            return *index[i].second;
+        }
+    }
+
+    std::unique_ptr<PRedisCommandMetrics> metrics(new PRedisCommandMetrics());
+    metrics->command  = cmd;
+    metrics->endpoint = endpoint->name;
+    index.push_back(std::make_pair(cmd, metrics.get()));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    commands_.push_back(std::move(metrics));
+    return *commands_.back();
+}
+
+void PRedisMetrics::collect(PRedisMetricsSnapshot &snapshot) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        snapshot.merge(*commands_[i]);
+    }
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        PRedisEndpointMetricsSnapshot endpoint;
+        endpoint.endpoint   = endpoints_[i]->name;
+        endpoint.reconnects = endpoints_[i]->reconnects.load(std::memory_order_relaxed);
+        snapshot.merge(endpoint);
+    }
+}
+
+PRedisMetricsRegistry &PRedisMetricsRegistry::instance()
+{
+    static PRedisMetricsRegistry registry;
+    return registry;
+}
+
+void PRedisMetricsRegistry::add(PRedisMetrics *metrics)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.push_back(metrics);
+}
+
+void PRedisMetricsRegistry::remove(PRedisMetrics *metrics)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < metrics_.size(); ++i) {
+        if (metrics_[i] == metrics) {
+            metrics_[i] = metrics_.back();
+            metrics_.pop_back();
+            break;
+        }
+    }
+    metrics->collect(retired_);
+}
+
+void PRedisMetricsRegistry::collect(PRedisMetricsSnapshot &snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < retired_.commands.size(); ++i) {
+        snapshot.merge(retired_.commands[i]);
+    }
+    for (size_t i = 0; i < retired_.endpoints.size(); ++i) {
+        snapshot.merge(retired_.endpoints[i]);
+    }
+    for (size_t i = 0; i < metrics_.size(); ++i) {
+        metrics_[i]->collect(snapshot);
+    }
+}
+
+void PRedisMetricsRegistry::export_prometheus(std::string &out)
+{
+    PRedisMetricsSnapshot snapshot;
+    collect(snapshot);
+    snapshot.export_prometheus(out);
+}
@@ -0,0 +1,259 @@
+/*
+ * FileName : p_redis_metrics.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 02 Nov 2026 10:18:36 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * 指标只由所属线程写, 写入是 relaxed 的 load + store, 没有锁也没有原子 RMW;
+     * 汇总线程 relaxed 读, 读到的值可能略旧但不会撕裂
+     */
+    inline void predis_metric_add(std::atomic<uint64_t> &counter, uint64_t n)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline void predis_metric_add(uint64_t &counter, uint64_t n)
+    {
+        counter += n;
+    }
+
+    inline uint64_t predis_metric_load(const std::atomic<uint64_t> &counter)
+    {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t predis_metric_load(uint64_t counter)
+    {
+        return counter;
+    }
+
+    /*
+     * @brief HDR 风格的对数-线性直方图, 单位微秒
+     * 每个 2 的幂区间分 8 格, 相对误差不超过 12.5%; 0~15us 精确
+     */
+    template <typename Count>
+    class PRedisBasicHistogram
+    {
+        public:
+            static const int kSubBits = 3;
+            static const int kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+            PRedisBasicHistogram()
+            {
+                for (int i = 0; i < kBuckets; ++i) {
+                    buckets_[i] = 0;
+                }
+                count_ = 0;
+                sum_   = 0;
+            }
+
+            void record(uint64_t us)
+            {
+                predis_metric_add(buckets_[index(us)], 1);
+                predis_metric_add(count_, 1);
+                predis_metric_add(sum_, us);
+            }
+
+            template <typename U>
+            void merge(const PRedisBasicHistogram<U> &other)
+            {
+                for (int i = 0; i < kBuckets; ++i) {
+                    predis_metric_add(buckets_[i], other.bucket(i));
+                }
+                predis_metric_add(count_, other.count());
+                predis_metric_add(sum_, other.sum());
+            }
+
+            uint64_t bucket(int i) const { return predis_metric_load(buckets_[i]); }
+            uint64_t count() const { return predis_metric_load(count_); }
+            uint64_t sum() const { return predis_metric_load(sum_); }
+
+            /* p 取 [0, 1], 返回所在格的上界 */
+            uint64_t percentile(double p) const
+            {
+                uint64_t total = count();
+                if (0 == total) {
+                    return 0;
+                }
+                uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+                uint64_t seen = 0;
+                for (int i = 0; i < kBuckets; ++i) {
+                    seen += bucket(i);
+                    if (seen >= rank) {
+                        return upper_bound(i);
+                    }
+                }
+                return upper_bound(kBuckets - 1);
+            }
+
+            static int index(uint64_t us)
+            {
+                if (us < (2u << kSubBits)) {
+                    return static_cast<int>(us);
+                }
+                int msb = 63 - __builtin_clzll(us);
+                int shift = msb - kSubBits;
+                int sub = static_cast<int>((us >> shift) & ((1u << kSubBits) - 1));
+                return ((shift + 1) << kSubBits) + sub;
+            }
+
+            /* 第 i 格包含的最大值 */
+            static uint64_t upper_bound(int i)
+            {
+                if (i < (2 << kSubBits)) {
+                    return static_cast<uint64_t>(i);
+                }
+                int shift = (i >> kSubBits) - 1;
+                uint64_t base = static_cast<uint64_t>((1 << kSubBits) | (i & ((1 << kSubBits) - 1)));
+                return ((base + 1) << shift) - 1;
+            }
+
+        private:
+            Count buckets_[kBuckets];
+            Count count_;
+            Count sum_;
+    };
+
+    typedef PRedisBasicHistogram< std::atomic<uint64_t> > PRedisHistogram;
+    typedef PRedisBasicHistogram<uint64_t>                PRedisHistogramSnapshot;
+
+    /*
+     * @brief 一个 (命令, 节点) 的指标
+     */
+    template <typename Count>
+    struct PRedisBasicCommandMetrics
+    {
+        std::string command;
+        std::string endpoint;
+
+        Count ops            {0};
+        Count errors         {0};
+        Count nils           {0};
+        Count bytes_sent     {0};
+        Count bytes_received {0};
+
+        PRedisBasicHistogram<Count> latency;
+
+        template <typename U>
+        void merge(const PRedisBasicCommandMetrics<U> &other)
+        {
+            predis_metric_add(ops, predis_metric_load(other.ops));
+            predis_metric_add(errors, predis_metric_load(other.errors));
+            predis_metric_add(nils, predis_metric_load(other.nils));
+            predis_metric_add(bytes_sent, predis_metric_load(other.bytes_sent));
+            predis_metric_add(bytes_received, predis_metric_load(other.bytes_received));
+            latency.merge(other.latency);
+        }
+    };
+
+    typedef PRedisBasicCommandMetrics< std::atomic<uint64_t> > PRedisCommandMetrics;
+    typedef PRedisBasicCommandMetrics<uint64_t>                PRedisCommandMetricsSnapshot;
+
+    struct PRedisEndpointMetricsSnapshot
+    {
+        std::string endpoint;
+        uint64_t    reconnects = 0;
+    };
+
+    struct PRedisMetricsSnapshot
+    {
+        std::vector<PRedisCommandMetricsSnapshot>  commands;
+        std::vector<PRedisEndpointMetricsSnapshot> endpoints;
+
+        template <typename Count>
+        void merge(const PRedisBasicCommandMetrics<Count> &metrics)
+        {
+            for (size_t i = 0; i < commands.size(); ++i) {
+                if (commands[i].command == metrics.command && commands[i].endpoint == metrics.endpoint) {
+                    commands[i].merge(metrics);
+                    return;
+                }
+            }
+
+            commands.emplace_back();
+            commands.back().command  = metrics.command;
+            commands.back().endpoint = metrics.endpoint;
+            commands.back().merge(metrics);
+        }
+
+        void merge(const PRedisEndpointMetricsSnapshot &endpoint);
+
+        /* Prometheus 文本格式, 追加到 out */
+        void export_prometheus(std::string &out) const;
+    };
+
+    /*
+     * @brief 一个线程 (一个 PRedisClient) 的指标
+     *
+     * 热路径上只有所属线程访问: 按节点、命令名查找 (命令名先比较指针),
+     * 然后对计数器做无锁累加. 新增条目时才加锁, 与 collect 互斥;
+     * 条目地址固定, 析构时计数并入全局 registry, 汇总结果不会倒退.
+     */
+    class PRedisMetrics : public noncopyable
+    {
+        public:
+            PRedisMetrics();
+            ~PRedisMetrics();
+
+            struct Endpoint
+            {
+                std::string                                        name;
+                std::atomic<uint64_t>                              reconnects {0};
+                std::vector< std::pair<const char *, PRedisCommandMetrics *> > index;
+            };
+
+            /* 按 "host:port" 取节点, 节点地址变化时调用一次, 之后直接用返回值 */
+            Endpoint *endpoint(const std::string &name);
+
+            /* cmd 需要是字符串常量 */
+            PRedisCommandMetrics &command(Endpoint *endpoint, const char *cmd);
+
+            void collect(PRedisMetricsSnapshot &snapshot) const;
+
+        private:
+            mutable std::mutex                                  mutex_;
+            std::vector< std::unique_ptr<Endpoint> >            endpoints_;
+            std::vector< std::unique_ptr<PRedisCommandMetrics> > commands_;
+    };
+
+    /*
+     * @brief 进程内所有 PRedisMetrics 的登记处, 按需汇总
+     */
+    class PRedisMetricsRegistry : public noncopyable
+    {
+        public:
+            static PRedisMetricsRegistry &instance();
+
+            void add(PRedisMetrics *metrics);
+            void remove(PRedisMetrics *metrics);
+
+            /* 汇总所有线程及已销毁线程的指标 */
+            void collect(PRedisMetricsSnapshot &snapshot);
+
+            void export_prometheus(std::string &out);
+
+        private:
+            PRedisMetricsRegistry() {}
+
+            std::mutex                    mutex_;
+            std::vector<PRedisMetrics *>  metrics_;
+            PRedisMetricsSnapshot         retired_;
+    };
+
+}
@@ -0,0 +1,100 @@
+/*
+ * FileName : p_redis_phase.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 03 Nov 2026 02:41:07 PM CST   Created
+*/
+
+#include "p_redis_phase.h"
+
+#include <string.h>
+#include <time.h>
+
+using namespace pepper;
+
+static const char *s_phase_names[PREDIS_PHASE_COUNT] = {
+    "format", "append", "write", "wait", "parse", "decode"
+};
+
+const char *pepper::predis_phase_name(PRedisPhase phase)
+{
+    return phase >= 0 && phase < PREDIS_PHASE_COUNT ? s_phase_names[phase] : "unknown";
+}
+
+static uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static double calibrate()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ns0    = monotonic_ns();
+    uint64_t ticks0 = predis_ticks();
+    uint64_t ns1    = ns0;
+    while (ns1 - ns0 < 10000000ULL) {
+        ns1 = monotonic_ns();
+    }
+    uint64_t ticks1 = predis_ticks();
+
+    return static_cast<double>(ticks1 - ticks0) / static_cast<double>(ns1 - ns0);
+#else
+    return 1.0;
+#endif
+}
+
+double pepper::predis_ticks_per_ns()
+{
+    static const double ticks_per_ns = calibrate();
+    return ticks_per_ns;
+}
+
+double PRedisPhaseCounters::avg_ns(PRedisPhase phase) const
+{
+    if (0 == samples) {
+        return 0;
+    }
+
+    return static_cast<double>(ticks[phase]) / predis_ticks_per_ns() / static_cast<double>(samples);
+}
+
+void PRedisPhaseTimer::finish(const char *cmd)
+{
+    if (!sampling_) {
+        return;
+    }
+    sampling_ = false;
+
+    PRedisPhaseCounters *counters = nullptr;
+    for (auto &c : counters_) {
+        if (c.command == cmd || 0 == strcmp(c.command, cmd)) {
+            counters = &c;
+            break;
+        }
+    }
+    if (nullptr == counters) {
+        PRedisPhaseCounters c;
+        memset(&c, 0, sizeof(c));
+        c.command = cmd;
+        counters_.push_back(c);
+        counters = &counters_.back();
+    }
+
+    ++counters->samples;
+    for (int i = 0; i < PREDIS_PHASE_COUNT; ++i) {
+        counters->ticks[i] += ticks_[i];
+    }
+    pending_   = counters;
+    last_tick_ = predis_ticks();
+}
+
+void PRedisPhaseTimer::reset()
+{
+    pending_ = nullptr;
+    for (auto &c : counters_) {
+        c.samples = 0;
+        memset(c.ticks, 0, sizeof(c.ticks));
+    }
+}
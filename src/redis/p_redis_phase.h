@@ -0,0 +1,150 @@
+/*
+ * FileName : p_redis_phase.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 03 Nov 2026 02:41:07 PM CST   Created
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+namespace pepper
+{
+
+    /*
+     * @brief 一条命令在客户端经过的阶段
+     *   FORMAT  begin_command 到发送前: 参数编码、压缩、连接和截止时间检查
+     *   APPEND  命令复制进 hiredis 的输出缓冲区
+     *   WRITE   redisBufferWrite 写 socket
+     *   WAIT    等待 socket 可读及 read 系统调用, 主要是网络和服务端耗时
+     *   PARSE   read.c 解析回复
+     *   DECODE  回复复制到 std::string 或按 PRedisCodec 解码
+     */
+    enum PRedisPhase
+    {
+        PREDIS_PHASE_FORMAT = 0,
+        PREDIS_PHASE_APPEND,
+        PREDIS_PHASE_WRITE,
+        PREDIS_PHASE_WAIT,
+        PREDIS_PHASE_PARSE,
+        PREDIS_PHASE_DECODE,
+        PREDIS_PHASE_COUNT
+    };
+
+    const char *predis_phase_name(PRedisPhase phase);
+
+    /* x86 上为 rdtsc, 其他平台为 CLOCK_MONOTONIC 纳秒 */
+    inline uint64_t predis_ticks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+    }
+
+    /* 每纳秒的 tick 数, 第一次调用时校准 (约 10ms), 开启采样或慢日志时预先调用, 不落在命令路径上 */
+    double predis_ticks_per_ns();
+
+    struct PRedisPhaseCounters
+    {
+        const char *command;
+        uint64_t    samples;
+        uint64_t    ticks[PREDIS_PHASE_COUNT];
+
+        /* 该阶段每个样本的平均纳秒数 */
+        double avg_ns(PRedisPhase phase) const;
+    };
+
+    /*
+     * @brief 按命令汇总的阶段耗时, 每 sample_every 条命令采样一条.
+     * 未采样的命令只有一次计数判断, 采样的命令每个阶段读一次 tsc.
+     * start(true) 时未采样的命令也计时 (供慢日志使用), 但不计入汇总
+     */
+    class PRedisPhaseTimer
+    {
+        public:
+            PRedisPhaseTimer()
+                : sample_every_(0), seq_(0), sampling_(false), timing_(false), last_tick_(0), pending_(nullptr)
+            {
+                for (int i = 0; i < PREDIS_PHASE_COUNT; ++i) {
+                    ticks_[i] = 0;
+                }
+            }
+
+            /* 0 关闭, 1 每条命令都计时 */
+            void set_sample_every(uint32_t n) { sample_every_ = n; }
+
+            /* 命令开始, 决定本条命令是否采样; timed 为 true 时总是计时 */
+            void start(bool timed = false)
+            {
+                pending_  = nullptr;
+                sampling_ = sample_every_ != 0 && ++seq_ >= sample_every_;
+                if (sampling_) {
+                    seq_ = 0;
+                }
+                timing_ = sampling_ || timed;
+                if (!timing_) {
+                    return;
+                }
+                last_tick_ = predis_ticks();
+                for (int i = 0; i < PREDIS_PHASE_COUNT; ++i) {
+                    ticks_[i] = 0;
+                }
+            }
+
+            /* 本条命令计入汇总, 写、等待、解析需要分开计时 */
+            bool sampling() const { return sampling_; }
+
+            /* 本条命令在计时, 各阶段的 tick 数见 ticks() */
+            bool timing() const { return timing_; }
+            const uint64_t *ticks() const { return ticks_; }
+
+            /* 上一个检查点到现在的时间计入 phase */
+            void mark(PRedisPhase phase)
+            {
+                if (timing_) {
+                    uint64_t now = predis_ticks();
+                    ticks_[phase] += now - last_tick_;
+                    last_tick_ = now;
+                }
+            }
+
+            /* 回复已取到, 样本计入 cmd; 之后的解码由 decoded() 补上 */
+            void finish(const char *cmd);
+
+            /* 回复的解码结束, 计入最近一次 finish 的命令 */
+            void decoded()
+            {
+                if (pending_ != nullptr) {
+                    pending_->ticks[PREDIS_PHASE_DECODE] += predis_ticks() - last_tick_;
+                    pending_ = nullptr;
+                }
+            }
+
+            const std::vector<PRedisPhaseCounters> &counters() const { return counters_; }
+
+            void reset();
+
+        private:
+            uint32_t                         sample_every_;
+            uint32_t                         seq_;
+            bool                             sampling_;
+            bool                             timing_;
+            uint64_t                         last_tick_;
+            uint64_t                         ticks_[PREDIS_PHASE_COUNT];
+            PRedisPhaseCounters             *pending_;
+            std::vector<PRedisPhaseCounters> counters_;
+    };
+
+}
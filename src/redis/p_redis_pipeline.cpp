@@ -0,0 +1,116 @@
+/*
+ * FileName : p_redis_pipeline.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 02:20:43 PM CST   Created
+*/
+
+#include "p_redis_pipeline.h"
+
+#include <libpc/pc_logger.h>
+
+using namespace pepper;
+
+PRedisPipeline::PRedisPipeline(PRedisConnection &connection, const PRedisPipelineOptions &options)
+    : connection_(connection), options_(options), in_flight_bytes_(0)
+{
+    if (options_.max_inflight_commands == 0) {
+        options_.max_inflight_commands = 1;
+    }
+    if (options_.max_inflight_bytes == 0) {
+        options_.max_inflight_bytes = 1;
+    }
+}
+
+PRedisPipeline::~PRedisPipeline()
+{
+}
+
+bool PRedisPipeline::window_full() const
+{
+    return in_flight_.size() >= options_.max_inflight_commands
+        || in_flight_bytes_ >= options_.max_inflight_bytes;
+}
+
+/*
+ * 窗口满后读到一半以下再继续写, 每次写出的都是较大的块,
+ * 而不是每读一个回复就写一条命令
+ */
+int PRedisPipeline::run(const Producer &producer, const Consumer &consumer,
+                        PRedisPipelineStats *stats)
+{
+    PRedisPipelineStats local;
+    PRedisPipelineStats &st = stats ? *stats : local;
+
+    PRespWriter writer(out_);
+    out_.clear();
+    in_flight_.clear();
+    in_flight_bytes_ = 0;
+
+    bool more = true;
+    size_t unsent = 0;
+    while (more || !in_flight_.empty()) {
+        while (more && !window_full() && out_.size() < options_.chunk_bytes) {
+            size_t before = out_.size();
+            more = producer(writer);
+            if (!more) {
+                out_.resize(before);
+                break;
+            }
+            size_t len = out_.size() - before;
+            in_flight_.push_back(len);
+            in_flight_bytes_ += len;
+            ++unsent;
+            ++st.commands;
+        }
+
+        if (!out_.empty()) {
+            if (0 != connection_.write_raw(out_.data(), out_.size(), unsent)) {
+                pc_log_error("pipeline error: write failed after %llu replies",
+                             static_cast<unsigned long long>(st.replies));
+                return -1;
+            }
+            st.bytes_sent += out_.size();
+            out_.clear();
+            unsent = 0;
+        }
+
+        if (!more) {
+            if (0 != read_replies(0, 0, consumer, st)) {
+                return -1;
+            }
+        } else if (window_full()) {
+            if (0 != read_replies(options_.max_inflight_commands / 2,
+                                  options_.max_inflight_bytes / 2, consumer, st)) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int PRedisPipeline::read_replies(size_t keep_commands, size_t keep_bytes,
+                                 const Consumer &consumer, PRedisPipelineStats &st)
+{
+    while (!in_flight_.empty()
+            && (in_flight_.size() > keep_commands || in_flight_bytes_ > keep_bytes)) {
+        PRedisReply reply;
+        if (0 != connection_.read_reply(reply)) {
+            pc_log_error("pipeline error: read failed after %llu replies",
+                         static_cast<unsigned long long>(st.replies));
+            return -1;
+        }
+
+        in_flight_bytes_ -= in_flight_.front();
+        in_flight_.pop_front();
+        if (reply->type == REDIS_REPLY_ERROR) {
+            ++st.errors;
+        }
+        if (consumer) {
+            consumer(st.replies, reply.get());
+        }
+        ++st.replies;
+    }
+
+    return 0;
+}
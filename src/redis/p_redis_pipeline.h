@@ -0,0 +1,75 @@
+/*
+ * FileName : p_redis_pipeline.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 02:20:43 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+#include "p_redis_resp.h"
+
+#include <deque>
+#include <functional>
+#include <string>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisPipelineOptions
+    {
+        size_t max_inflight_commands = 10000;       /* 已编码但未收到回复的命令数上限 */
+        size_t max_inflight_bytes    = 16 << 20;    /* 这些命令的字节数上限 */
+        size_t chunk_bytes           = 256 << 10;   /* 积累多少字节写一次 socket */
+    };
+
+    struct PRedisPipelineStats
+    {
+        uint64_t commands   = 0;
+        uint64_t replies    = 0;
+        uint64_t errors     = 0;    /* REDIS_REPLY_ERROR 的个数 */
+        uint64_t bytes_sent = 0;
+    };
+
+    /*
+     * @brief 流式 pipeline, 内存占用与命令总数无关
+     *
+     * producer 每次调用向 writer 写入一条命令, 没有更多命令时返回 false;
+     * 只有在途命令数和字节数都低于上限时才会调用 producer, 以此对生产方
+     * 施加背压. 每个回复到达后立即交给 consumer, 回调返回后回复即被释放,
+     * consumer 不能保存 reply 指针. seq 为命令序号, 从0开始.
+     */
+    class PRedisPipeline : public noncopyable
+    {
+        public:
+            typedef std::function<bool (PRespWriter &writer)> Producer;
+            typedef std::function<void (uint64_t seq, const redisReply *reply)> Consumer;
+
+            PRedisPipeline(PRedisConnection &connection,
+                           const PRedisPipelineOptions &options = PRedisPipelineOptions());
+            ~PRedisPipeline();
+
+            /*
+             * return 0 所有命令都已发送并收到回复(可能包含错误回复)
+             *       -1 连接异常, stats 中为已完成的部分
+             */
+            int run(const Producer &producer, const Consumer &consumer,
+                    PRedisPipelineStats *stats = nullptr);
+
+        private:
+            bool window_full() const;
+            int read_replies(size_t keep_commands, size_t keep_bytes,
+                             const Consumer &consumer, PRedisPipelineStats &stats);
+
+            PRedisConnection     &connection_;
+            PRedisPipelineOptions options_;
+
+            std::string           out_;
+            std::deque<size_t>    in_flight_;       /* 在途命令各自的字节数 */
+            size_t                in_flight_bytes_;
+    };
+
+}
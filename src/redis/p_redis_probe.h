@@ -0,0 +1,101 @@
+/*
+ * FileName : p_redis_probe.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Wed 04 Nov 2026 11:07:52 AM CST   Created
+*/
+
+/*
+ * USDT 静态探针, hiredis (C) 和 PRedisClient 共用.
+ *
+ * 编译时定义 PREDIS_USDT 且有 <sys/sdt.h> (systemtap-sdt-dev) 时生效,
+ * 探针在指令流中是一条 nop, 由 semaphore 守护: 没有 tracer 附加时参数和计时都不计算;
+ * 否则宏展开为空.
+ * provider 为 predis:
+ *   connect(fd, host, port, rv, ns)        TCP/unix 连接, unix 时 port 为 0
+ *   reconnect(fd, rv)                      redisReconnect 结束
+ *   append(fd, buf, len)                   命令追加到输出缓冲区, buf 为 RESP 文本
+ *   write(fd, bytes, ns)                   一次 write 系统调用, 失败时 bytes 为 -1
+ *   read(fd, bytes, ns)                    一次 read 系统调用
+ *   reply(fd, reply)                       解析出一个完整回复, reply 为回复对象指针
+ *   command(fd, cmd, error, us)            PRedisClient 的一条命令结束, error 为 PRedisError
+ *
+ * 例: bpftrace -e 'usdt:./app:predis:command { @[str(arg1)] = hist(arg3); }'
+ */
+
+#pragma once
+
+#if defined(PREDIS_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define PREDIS_PROBE_ENABLED 1
+#endif
+#endif
+
+#ifdef PREDIS_PROBE_ENABLED
+
+#include <time.h>
+
+/*
+ * 每个探针一个 semaphore, 由 bpftrace/perf/systemtap 附加时加 1.
+ * 没有附加时只多一次内存读和分支, 参数和时间戳都不计算
+ */
+#define PREDIS_PROBE_SEMAPHORE(name)    predis_##name##_semaphore
+#define PREDIS_PROBE_DECLARE(name)      \
+    extern unsigned short PREDIS_PROBE_SEMAPHORE(name) __attribute__((unused, section(".probes")))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+PREDIS_PROBE_DECLARE(connect);
+PREDIS_PROBE_DECLARE(reconnect);
+PREDIS_PROBE_DECLARE(append);
+PREDIS_PROBE_DECLARE(write);
+PREDIS_PROBE_DECLARE(read);
+PREDIS_PROBE_DECLARE(reply);
+PREDIS_PROBE_DECLARE(command);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* hiredis.c 中定义一次 */
+#define PREDIS_PROBE_DEFINE(name)       \
+    unsigned short PREDIS_PROBE_SEMAPHORE(name) __attribute__((unused, section(".probes"))) = 0
+
+#define PREDIS_PROBE_ACTIVE(name)       __builtin_expect(PREDIS_PROBE_SEMAPHORE(name) != 0, 0)
+
+static inline unsigned long long predis_probe_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/* 开始时未附加则为 0, 中途附加的那一次上报 0 而不是一个错误的时长 */
+#define PREDIS_PROBE_START(name, var)   \
+    unsigned long long var = PREDIS_PROBE_ACTIVE(name) ? predis_probe_now_ns() : 0
+#define PREDIS_PROBE_SINCE(var)         ((var) != 0 ? predis_probe_now_ns() - (var) : 0)
+
+#define PREDIS_PROBE2(name, a, b)                                               \
+    do { if (PREDIS_PROBE_ACTIVE(name)) DTRACE_PROBE2(predis, name, a, b); } while (0)
+#define PREDIS_PROBE3(name, a, b, c)                                            \
+    do { if (PREDIS_PROBE_ACTIVE(name)) DTRACE_PROBE3(predis, name, a, b, c); } while (0)
+#define PREDIS_PROBE4(name, a, b, c, d)                                         \
+    do { if (PREDIS_PROBE_ACTIVE(name)) DTRACE_PROBE4(predis, name, a, b, c, d); } while (0)
+#define PREDIS_PROBE5(name, a, b, c, d, e)                                      \
+    do { if (PREDIS_PROBE_ACTIVE(name)) DTRACE_PROBE5(predis, name, a, b, c, d, e); } while (0)
+
+#else
+
+#define PREDIS_PROBE_DEFINE(name)       struct predis_probe_unused_##name
+#define PREDIS_PROBE_START(name, var)
+#define PREDIS_PROBE_SINCE(var)         0
+
+#define PREDIS_PROBE2(name, a, b)
+#define PREDIS_PROBE3(name, a, b, c)
+#define PREDIS_PROBE4(name, a, b, c, d)
+#define PREDIS_PROBE5(name, a, b, c, d, e)
+
+#endif
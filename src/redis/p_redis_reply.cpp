@@ -0,0 +1,222 @@
+/*
+ * FileName : p_redis_reply.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 23 Oct 2026 10:21:14 AM CST   Created
+*/
+
+#include "p_redis_reply.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace pepper;
+
+redisReplyObjectFunctions PRedisReplyPool::s_functions = {
+    PRedisReplyPool::create_string,
+    PRedisReplyPool::create_array,
+    PRedisReplyPool::create_integer,
+    PRedisReplyPool::create_nil,
+    PRedisReplyPool::free_object
+};
+
+PRedisReplyPool::PRedisReplyPool(size_t max_nodes, size_t max_string)
+    : prev_fn_(nullptr), prev_privdata_(nullptr), free_list_(nullptr), free_count_(0), max_nodes_(max_nodes),
+      max_string_(max_string), allocated_(0)
+{
+}
+
+PRedisReplyPool::~PRedisReplyPool()
+{
+    while (free_list_ != nullptr) {
+        Node *node = free_list_;
+        free_list_ = node->next;
+        hi_free(node->buf);
+        hi_free(node->elements);
+        hi_free(node);
+    }
+}
+
+void PRedisReplyPool::attach(redisContext *context)
+{
+    if (attached(context)) {
+        return;
+    }
+
+    prev_fn_       = context->reader->fn;
+    prev_privdata_ = context->reader->privdata;
+    context->reader->fn       = &s_functions;
+    context->reader->privdata = this;
+}
+
+bool PRedisReplyPool::attached(const redisContext *context) const
+{
+    return context->reader->fn == &s_functions && context->reader->privdata == this;
+}
+
+void PRedisReplyPool::detach(redisContext *context)
+{
+    if (!attached(context)) {
+        return;
+    }
+
+    context->reader->fn       = prev_fn_;
+    context->reader->privdata = prev_privdata_;
+}
+
+PRedisReplyPool::Node *PRedisReplyPool::acquire(int type)
+{
+    Node *node = free_list_;
+    if (node != nullptr) {
+        free_list_ = node->next;
+        --free_count_;
+    } else {
+        node = static_cast<Node *>(hi_calloc(1, sizeof(Node)));
+        if (nullptr == node) {
+            return nullptr;
+        }
+        node->pool = this;
+        ++allocated_;
+    }
+
+    node->next           = nullptr;
+    node->reply.type     = type;
+    node->reply.flags    = 0;
+    node->reply.integer  = 0;
+    node->reply.len      = 0;
+    node->reply.str      = nullptr;
+    node->reply.elements = 0;
+    node->reply.element  = nullptr;
+
+    return node;
+}
+
+/*
+ * 数组的子节点一起回收; 过大的字符串缓冲和超出上限的节点直接释放
+ */
+void PRedisReplyPool::release(Node *node)
+{
+    if (node->reply.type == REDIS_REPLY_ARRAY) {
+        for (size_t i = 0; i < node->reply.elements; ++i) {
+            if (node->reply.element[i] != nullptr) {
+                release(reinterpret_cast<Node *>(node->reply.element[i]));
+            }
+        }
+    }
+
+    if (node->buf_cap > max_string_) {
+        hi_free(node->buf);
+        node->buf     = nullptr;
+        node->buf_cap = 0;
+    }
+    if (free_count_ >= max_nodes_) {
+        hi_free(node->buf);
+        hi_free(node->elements);
+        hi_free(node);
+        return;
+    }
+
+    node->next = free_list_;
+    free_list_ = node;
+    ++free_count_;
+}
+
+PRedisReplyPool::Node *PRedisReplyPool::attach_to_parent(const redisReadTask *task, Node *node)
+{
+    if (task->parent != nullptr) {
+        redisReply *parent = static_cast<redisReply *>(task->parent->obj);
+        parent->element[task->idx] = &node->reply;
+    }
+
+    return node;
+}
+
+void *PRedisReplyPool::create_string(const redisReadTask *task, char *str, size_t len)
+{
+    PRedisReplyPool *pool = static_cast<PRedisReplyPool *>(task->privdata);
+    Node *node = pool->acquire(task->type);
+    if (nullptr == node) {
+        return nullptr;
+    }
+
+    char *dst = node->inline_buf;
+    if (len > REDIS_REPLY_INLINE_MAX) {
+        if (node->buf_cap < len + 1) {
+            char *buf = static_cast<char *>(hi_realloc(node->buf, len + 1));
+            if (nullptr == buf) {
+                pool->release(node);
+                return nullptr;
+            }
+            node->buf     = buf;
+            node->buf_cap = len + 1;
+        }
+        dst = node->buf;
+    }
+    memcpy(dst, str, len);
+    dst[len]          = '\0';
+    node->reply.flags = dst == node->inline_buf ? REDIS_REPLY_STR_INLINE : 0;
+    node->reply.str   = dst;
+    node->reply.len   = len;
+
+    return attach_to_parent(task, node);
+}
+
+void *PRedisReplyPool::create_array(const redisReadTask *task, int elements)
+{
+    PRedisReplyPool *pool = static_cast<PRedisReplyPool *>(task->privdata);
+    Node *node = pool->acquire(REDIS_REPLY_ARRAY);
+    if (nullptr == node) {
+        return nullptr;
+    }
+
+    size_t count = elements > 0 ? static_cast<size_t>(elements) : 0;
+    if (node->elements_cap < count) {
+        redisReply **array = static_cast<redisReply **>(
+                hi_realloc(node->elements, count * sizeof(redisReply *)));
+        if (nullptr == array) {
+            pool->release(node);
+            return nullptr;
+        }
+        node->elements     = array;
+        node->elements_cap = count;
+    }
+    if (count > 0) {
+        memset(node->elements, 0, count * sizeof(redisReply *));
+    }
+    node->reply.element  = node->elements;
+    node->reply.elements = count;
+
+    return attach_to_parent(task, node);
+}
+
+void *PRedisReplyPool::create_integer(const redisReadTask *task, long long value)
+{
+    PRedisReplyPool *pool = static_cast<PRedisReplyPool *>(task->privdata);
+    Node *node = pool->acquire(REDIS_REPLY_INTEGER);
+    if (nullptr == node) {
+        return nullptr;
+    }
+    node->reply.integer = value;
+
+    return attach_to_parent(task, node);
+}
+
+void *PRedisReplyPool::create_nil(const redisReadTask *task)
+{
+    PRedisReplyPool *pool = static_cast<PRedisReplyPool *>(task->privdata);
+    Node *node = pool->acquire(REDIS_REPLY_NIL);
+    if (nullptr == node) {
+        return nullptr;
+    }
+
+    return attach_to_parent(task, node);
+}
+
+void PRedisReplyPool::free_object(void *reply)
+{
+    if (nullptr == reply) {
+        return;
+    }
+
+    Node *node = reinterpret_cast<Node *>(reply);
+    node->pool->release(node);
+}
@@ -0,0 +1,137 @@
+/*
+ * FileName : p_redis_reply.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 23 Oct 2026 10:21:14 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "hiredis.h"
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 独占一个回复的句柄, 只能移动, 析构时释放
+     * 释放函数取自产生该回复的 reader (默认为 freeReplyObject),
+     * 由 PRedisReplyPool 产生的回复会回收到池中
+     */
+    class PRedisReply
+    {
+        public:
+            PRedisReply() : reply_(nullptr), free_(nullptr) {}
+            PRedisReply(redisReply *reply, void (*free_fn)(void *))
+                : reply_(reply), free_(free_fn) {}
+            ~PRedisReply() { reset(); }
+
+            PRedisReply(PRedisReply &&other) : reply_(other.reply_), free_(other.free_)
+            {
+                other.reply_ = nullptr;
+            }
+
+            PRedisReply &operator=(PRedisReply &&other)
+            {
+                if (this != &other) {
+                    reset();
+                    reply_ = other.reply_;
+                    free_  = other.free_;
+                    other.reply_ = nullptr;
+                }
+                return *this;
+            }
+
+            PRedisReply(const PRedisReply &) = delete;
+            PRedisReply &operator=(const PRedisReply &) = delete;
+
+            void reset()
+            {
+                if (reply_ != nullptr) {
+                    free_(reply_);
+                    reply_ = nullptr;
+                }
+            }
+
+            void reset(redisReply *reply, void (*free_fn)(void *))
+            {
+                reset();
+                reply_ = reply;
+                free_  = free_fn;
+            }
+
+            redisReply *get() const { return reply_; }
+            redisReply *operator->() const { return reply_; }
+            const redisReply &operator*() const { return *reply_; }
+            explicit operator bool() const { return reply_ != nullptr; }
+
+        private:
+            redisReply *reply_;
+            void      (*free_)(void *);
+    };
+
+    /*
+     * @brief 回复节点的空闲链表, 接管 hiredis reader 的回复构造
+     *
+     * 释放的节点连同其字符串缓冲和元素数组一起缓存, 下一个回复直接复用,
+     * 稳定状态下读取回复没有内存分配. 超过 max_string 的字符串缓冲不保留,
+     * 缓存的节点数不超过 max_nodes.
+     * 每条连接一个, 非线程安全; 池中产生的回复要在池析构前释放.
+     */
+    class PRedisReplyPool : public noncopyable
+    {
+        public:
+            explicit PRedisReplyPool(size_t max_nodes = 4096, size_t max_string = 64 << 10);
+            ~PRedisReplyPool();
+
+            /* 让 context 的 reader 从本池构造回复, 每次新建连接后调用 */
+            void attach(redisContext *context);
+            bool attached(const redisContext *context) const;
+
+            /* context 比池活得久时, 池析构前恢复 attach 之前的构造函数 */
+            void detach(redisContext *context);
+
+            /* 当前缓存的空闲节点数 */
+            size_t cached() const { return free_count_; }
+
+            /* 累计新分配的节点数, 稳定状态下不再增长 */
+            uint64_t allocated() const { return allocated_; }
+
+        private:
+            struct Node
+            {
+                redisReply        reply;        /* 必须是第一个成员 */
+                PRedisReplyPool  *pool;
+                Node             *next;
+                char             *buf;
+                size_t            buf_cap;
+                redisReply      **elements;
+                size_t            elements_cap;
+                char              inline_buf[REDIS_REPLY_INLINE_MAX + 1];   /* 短字符串不用 buf */
+            };
+
+            Node *acquire(int type);
+            void release(Node *node);
+
+            static void *create_string(const redisReadTask *task, char *str, size_t len);
+            static void *create_array(const redisReadTask *task, int elements);
+            static void *create_integer(const redisReadTask *task, long long value);
+            static void *create_nil(const redisReadTask *task);
+            static void free_object(void *reply);
+
+            static Node *attach_to_parent(const redisReadTask *task, Node *node);
+
+            static redisReplyObjectFunctions s_functions;
+
+            redisReplyObjectFunctions *prev_fn_;
+            void                      *prev_privdata_;
+
+            Node     *free_list_;
+            size_t    free_count_;
+            size_t    max_nodes_;
+            size_t    max_string_;
+            uint64_t  allocated_;
+    };
+
+}
@@ -0,0 +1,142 @@
+/*
+ * FileName : p_redis_resp.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 10:05:18 AM CST   Created
+*/
+
+#pragma once
+
+#include "p_string_ref.h"
+
+#include <string>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 把命令直接编码为 RESP 追加到缓冲区末尾
+     *
+     * 与 redisFormatCommandArgv 的输出一致:
+     *   *<argc>\r\n  $<len>\r\n<arg>\r\n ...
+     * 但不单独分配命令内存, 多条命令可以连续写入同一个缓冲区,
+     * 缓冲区 clear() 后容量保留, 稳定状态下没有内存分配.
+     */
+    class PRespWriter
+    {
+        public:
+            explicit PRespWriter(std::string &buf) : buf_(buf) {}
+
+            PRespWriter &begin(size_t argc)
+            {
+                append_prefixed('*', argc);
+                return *this;
+            }
+
+            PRespWriter &arg(const char *data, size_t len)
+            {
+                append_prefixed('$', len);
+                buf_.append(data, len);
+                buf_.append("\r\n", 2);
+                return *this;
+            }
+
+            PRespWriter &arg(const char *data)
+            {
+                return arg(data, strlen(data));
+            }
+
+            PRespWriter &arg(const std::string &data)
+            {
+                return arg(data.data(), data.size());
+            }
+
+            PRespWriter &arg(const PStringRef &data)
+            {
+                return arg(data.data(), data.size());
+            }
+
+            PRespWriter &arg(long long value)
+            {
+                char tmp[24];
+                size_t len = format_integer(tmp, value);
+                return arg(tmp, len);
+            }
+
+            /*
+             * @brief 参数长度已知、内容分段写入时使用:
+             *   arg_header(len); raw(...); raw(...); arg_end();
+             */
+            PRespWriter &arg_header(size_t len)
+            {
+                append_prefixed('$', len);
+                return *this;
+            }
+
+            /*
+             * @brief 预留 len 字节的参数并返回其地址, 调用者直接写入内容
+             * 返回的指针在下一次写缓冲区之前有效
+             */
+            char *arg_space(size_t len)
+            {
+                append_prefixed('$', len);
+                size_t pos = buf_.size();
+                buf_.resize(pos + len + 2);
+                buf_[pos + len]     = '\r';
+                buf_[pos + len + 1] = '\n';
+                return &buf_[pos];
+            }
+
+            PRespWriter &raw(const char *data, size_t len)
+            {
+                buf_.append(data, len);
+                return *this;
+            }
+
+            PRespWriter &arg_end()
+            {
+                buf_.append("\r\n", 2);
+                return *this;
+            }
+
+            std::string &buffer() { return buf_; }
+
+            /*
+             * @brief 十进制格式化, 返回长度, buf 至少 21 字节
+             */
+            static size_t format_integer(char *buf, long long value)
+            {
+                char tmp[24];
+                char *p = tmp + sizeof(tmp);
+                unsigned long long v = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                                 : static_cast<unsigned long long>(value);
+                do {
+                    *--p = static_cast<char>('0' + v % 10);
+                    v /= 10;
+                } while (v != 0);
+                if (value < 0) {
+                    *--p = '-';
+                }
+
+                size_t len = static_cast<size_t>(tmp + sizeof(tmp) - p);
+                memcpy(buf, p, len);
+                return len;
+            }
+
+        private:
+            void append_prefixed(char prefix, size_t n)
+            {
+                char tmp[32];
+                tmp[0] = prefix;
+                size_t len = 1 + format_integer(tmp + 1, static_cast<long long>(n));
+                tmp[len++] = '\r';
+                tmp[len++] = '\n';
+                buf_.append(tmp, len);
+            }
+
+            std::string &buf_;
+    };
+
+}
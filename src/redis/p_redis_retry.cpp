@@ -0,0 +1,113 @@
+/*
+ * FileName : p_redis_retry.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 26 Oct 2026 03:12:08 PM CST   Created
+*/
+
+#include "p_redis_retry.h"
+
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+using namespace pepper;
+
+/* 重复执行结果不变的命令, 按字母序 */
+static const char *s_idempotent_commands[] = {
+    "DEL", "EXISTS", "GET", "HDEL", "HEXISTS", "HGET", "HGETALL", "HKEYS", "HLEN",
+    "HMGET", "HMSET", "HSET", "HVALS", "KEYS", "LLEN", "LRANGE", "MGET", "MSET",
+    "PING", "SADD", "SCARD", "SET", "SISMEMBER", "SMEMBERS", "SREM", "STRLEN",
+    "TTL", "TYPE", "XACK", "XPENDING", "XRANGE", "ZADD", "ZCARD", "ZRANGE",
+    "ZRANGEBYSCORE", "ZREM", "ZSCORE"
+};
+
+PRedisBackoff::PRedisBackoff()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    state_ = static_cast<uint64_t>(ts.tv_nsec) ^ (reinterpret_cast<uintptr_t>(this) << 16)
+           ^ 0x9E3779B97F4A7C15ULL;
+    if (0 == state_) {
+        state_ = 1;
+    }
+}
+
+uint64_t PRedisBackoff::next()
+{
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+
+    return state_;
+}
+
+/*
+ * full jitter: 多个客户端同时失败时重试时间分散开, 不会一起打到刚恢复的节点上
+ */
+uint32_t PRedisBackoff::delay_ms(const PRedisRetryPolicy &policy, uint32_t attempt)
+{
+    uint64_t cap = policy.base_backoff_ms;
+    for (uint32_t i = 1; i < attempt && cap < policy.max_backoff_ms; ++i) {
+        cap <<= 1;
+    }
+    if (cap > policy.max_backoff_ms) {
+        cap = policy.max_backoff_ms;
+    }
+
+    return static_cast<uint32_t>(next() % (cap + 1));
+}
+
+void PRedisBackoff::sleep_ms(uint32_t delay_ms)
+{
+    struct timespec ts;
+    ts.tv_sec  = delay_ms / 1000;
+    ts.tv_nsec = static_cast<long>(delay_ms % 1000) * 1000000L;
+    while (0 != nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+void PRedisRetryPolicies::set(const char *cmd, const PRedisRetryPolicy &policy)
+{
+    for (auto &entry : entries_) {
+        if (entry.command == cmd || 0 == strcmp(entry.command, cmd)) {
+            entry.policy = policy;
+            return;
+        }
+    }
+
+    Entry entry = { cmd, policy };
+    entries_.push_back(entry);
+}
+
+const PRedisRetryPolicy &PRedisRetryPolicies::get(const char *cmd) const
+{
+    for (const auto &entry : entries_) {
+        if (entry.command == cmd || 0 == strcmp(entry.command, cmd)) {
+            return entry.policy;
+        }
+    }
+
+    return idempotent(cmd) ? default_ : no_retry_;
+}
+
+bool PRedisRetryPolicies::idempotent(const char *cmd)
+{
+    size_t lo = 0;
+    size_t hi = sizeof(s_idempotent_commands) / sizeof(s_idempotent_commands[0]);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcasecmp(cmd, s_idempotent_commands[mid]);
+        if (cmp == 0) {
+            return true;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return false;
+}
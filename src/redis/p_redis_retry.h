@@ -0,0 +1,79 @@
+/*
+ * FileName : p_redis_retry.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 26 Oct 2026 03:12:08 PM CST   Created
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 单个命令的重试策略, 只在 IO 错误(含超时)后重试,
+     * 服务端返回的错误不重试
+     * 第 n 次重试前等待 [0, min(max_backoff_ms, base_backoff_ms * 2^(n-1))] 内的随机时长
+     */
+    struct PRedisRetryPolicy
+    {
+        uint32_t max_attempts    = 1;       /* 包括第一次, 1 表示不重试 */
+        uint32_t base_backoff_ms = 2;
+        uint32_t max_backoff_ms  = 100;
+    };
+
+    /*
+     * @brief 带抖动的指数退避, 随机数用 xorshift, 不加锁
+     */
+    class PRedisBackoff
+    {
+        public:
+            PRedisBackoff();
+
+            /* attempt 从 1 开始, 返回第 attempt 次重试前的等待毫秒数 */
+            uint32_t delay_ms(const PRedisRetryPolicy &policy, uint32_t attempt);
+
+            /* 等待 delay_ms 毫秒 */
+            static void sleep_ms(uint32_t delay_ms);
+
+            uint64_t next();
+
+        private:
+            uint64_t state_;
+    };
+
+    /*
+     * @brief 按命令名配置的重试策略
+     *
+     * set_default() 只作用于幂等命令 (只读命令以及 SET/DEL/HSET 这类
+     * 重复执行结果相同的写命令); INCR/LPUSH/XADD 等非幂等命令默认不重试,
+     * 需要时用 set() 单独指定.
+     */
+    class PRedisRetryPolicies
+    {
+        public:
+            void set_default(const PRedisRetryPolicy &policy) { default_ = policy; }
+
+            /* cmd 需要是字符串常量, 只保存指针 */
+            void set(const char *cmd, const PRedisRetryPolicy &policy);
+
+            const PRedisRetryPolicy &get(const char *cmd) const;
+
+            static bool idempotent(const char *cmd);
+
+        private:
+            struct Entry
+            {
+                const char       *command;
+                PRedisRetryPolicy policy;
+            };
+
+            PRedisRetryPolicy  default_;
+            PRedisRetryPolicy  no_retry_;
+            std::vector<Entry> entries_;
+    };
+
+}
@@ -0,0 +1,175 @@
+/*
+ * FileName : p_redis_sentinel.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 30 Oct 2026 03:25:09 PM CST   Created
+*/
+
+#include "p_redis_sentinel.h"
+#include "p_redis_latency.h"
+
+#include <libpc/pc_logger.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace pepper;
+
+static const char s_switch_channel[] = "+switch-master";
+
+void PRedisEndpoint::set(const std::string &host, int port)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (host == host_ && port == port_) {
+        return;
+    }
+    host_ = host;
+    port_ = port;
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t PRedisEndpoint::get(std::string &host, int &port) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    host = host_;
+    port = port_;
+
+    return generation_.load(std::memory_order_relaxed);
+}
+
+PRedisSentinel::PRedisSentinel(const std::vector< std::pair<std::string, int> > &sentinels,
+                               const std::string &master_name,
+                               const PRedisSentinelOptions &options)
+    : sentinels_(sentinels), master_name_(master_name), options_(options),
+      endpoint_(std::make_shared<PRedisEndpoint>()), next_sentinel_(0), next_refresh_us_(0)
+{
+}
+
+int PRedisSentinel::resolve()
+{
+    for (size_t i = 0; i < sentinels_.size(); ++i) {
+        const auto &addr = sentinels_[(next_sentinel_ + i) % sentinels_.size()];
+        PRedisConnection conn(addr.first, addr.second);
+        if (0 != conn.connect(options_.timeout_ms)) {
+            continue;
+        }
+
+        args_.reset();
+        args_.push("SENTINEL", 8);
+        args_.push("get-master-addr-by-name", 23);
+        args_.push(master_name_);
+        PRedisReply reply = conn.command(args_);
+        if (!reply || reply->type != REDIS_REPLY_ARRAY || reply->elements != 2
+                || reply->element[0]->type != REDIS_REPLY_STRING
+                || reply->element[1]->type != REDIS_REPLY_STRING) {
+            pc_log_error("sentinel %s:%d has no address for %s", addr.first.c_str(), addr.second,
+                         master_name_.c_str());
+            continue;
+        }
+
+        endpoint_->set(std::string(reply->element[0]->str, reply->element[0]->len),
+                       atoi(reply->element[1]->str));
+        next_refresh_us_ = predis_now_us() + options_.refresh_ms * 1000ULL;
+        return 0;
+    }
+
+    pc_log_error("sentinel resolve %s error: no sentinel answered", master_name_.c_str());
+    return -1;
+}
+
+/*
+ * 订阅轮流连接各 sentinel, 订阅成功后再 resolve 一次, 补上断开期间的切换
+ */
+int PRedisSentinel::subscribe()
+{
+    for (size_t i = 0; i < sentinels_.size(); ++i) {
+        const auto &addr = sentinels_[next_sentinel_];
+        next_sentinel_ = (next_sentinel_ + 1) % sentinels_.size();
+
+        subscriber_.reset(new PRedisConnection(addr.first, addr.second));
+        if (0 != subscriber_->connect(options_.timeout_ms)) {
+            continue;
+        }
+        args_.reset();
+        args_.push("SUBSCRIBE", 9);
+        args_.push(s_switch_channel, sizeof(s_switch_channel) - 1);
+        PRedisReply reply = subscriber_->command(args_);
+        if (!reply || reply->type != REDIS_REPLY_ARRAY) {
+            continue;
+        }
+
+        /* 订阅后没有消息时读操作一直阻塞是正常的, 由 poll 控制等待时间 */
+        subscriber_->set_timeout(0);
+        resolve();
+        return 0;
+    }
+
+    subscriber_.reset();
+    return -1;
+}
+
+int PRedisSentinel::poll(int wait_ms)
+{
+    if ((!subscriber_ || !subscriber_->connected()) && 0 != subscribe()) {
+        return -1;
+    }
+    if (predis_now_us() >= next_refresh_us_) {
+        resolve();
+    }
+
+    struct pollfd pfd;
+    pfd.fd      = subscriber_->fd();
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    int ready = ::poll(&pfd, 1, wait_ms);
+    if (ready < 0 && errno != EINTR) {
+        subscriber_->close();
+        return -1;
+    }
+
+    int switched = 0;
+    bool readable = ready > 0;
+    for (;;) {
+        PRedisReply reply;
+        int ret = subscriber_->poll_reply(reply, readable);
+        if (ret < 0) {
+            return switched > 0 ? switched : -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+        switched += handle_message(reply.get());
+        readable = false;
+    }
+
+    return switched;
+}
+
+/*
+ * 消息格式: ["message", "+switch-master", "<name> <old-ip> <old-port> <new-ip> <new-port>"]
+ */
+int PRedisSentinel::handle_message(const redisReply *reply)
+{
+    if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 3
+            || reply->element[2]->type != REDIS_REPLY_STRING) {
+        return 0;
+    }
+
+    char name[256];
+    char old_ip[64];
+    char new_ip[64];
+    int old_port = 0;
+    int new_port = 0;
+    if (5 != sscanf(reply->element[2]->str, "%255s %63s %d %63s %d",
+                    name, old_ip, &old_port, new_ip, &new_port)
+            || master_name_ != name) {
+        return 0;
+    }
+
+    pc_log_error("sentinel: %s switched from %s:%d to %s:%d", name, old_ip, old_port, new_ip, new_port);
+    endpoint_->set(new_ip, new_port);
+
+    return 1;
+}
@@ -0,0 +1,98 @@
+/*
+ * FileName : p_redis_sentinel.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 30 Oct 2026 03:25:09 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_connection.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * @brief 当前主节点地址, 由 PRedisSentinel 更新, 多个客户端共享
+     * 地址变化时 generation 加一, 客户端在下一条命令前发现并切换. 线程安全
+     */
+    class PRedisEndpoint : public noncopyable
+    {
+        public:
+            PRedisEndpoint() : port_(0), generation_(0) {}
+
+            /* 地址不变时不增加 generation */
+            void set(const std::string &host, int port);
+
+            /* return 取到的地址对应的 generation, 还没有地址时为 0 */
+            uint64_t get(std::string &host, int &port) const;
+
+            uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+        private:
+            mutable std::mutex    mutex_;
+            std::string           host_;
+            int                   port_;
+            std::atomic<uint64_t> generation_;
+    };
+
+    struct PRedisSentinelOptions
+    {
+        uint32_t timeout_ms = 200;          /* 连接和查询 sentinel 的超时 */
+        uint32_t refresh_ms = 5000;         /* 订阅之外, 定期重新查询主节点 */
+    };
+
+    /*
+     * @brief 通过 Sentinel 发现主节点并跟随故障转移
+     *
+     * resolve() 依次询问各 sentinel (SENTINEL get-master-addr-by-name),
+     * 第一个有效回答写入 endpoint(). poll() 由定时器或独立协程周期调用,
+     * 处理 +switch-master 订阅消息, 主节点切换后立即更新 endpoint,
+     * 不必等旧主节点的 TCP 超时. 订阅连接断开后重连并重新 resolve,
+     * 以免错过断开期间的切换. 非线程安全, endpoint() 可以跨线程共享.
+     */
+    class PRedisSentinel : public noncopyable
+    {
+        public:
+            PRedisSentinel(const std::vector< std::pair<std::string, int> > &sentinels,
+                           const std::string &master_name,
+                           const PRedisSentinelOptions &options = PRedisSentinelOptions());
+
+            /* return 0 成功  -1 所有 sentinel 都没有给出地址 */
+            int resolve();
+
+            /*
+             * @brief 等待并处理订阅消息, 最多等 wait_ms
+             * return 主节点切换的次数, -1 订阅连接不可用
+             */
+            int poll(int wait_ms);
+
+            const std::shared_ptr<PRedisEndpoint> &endpoint() const { return endpoint_; }
+
+        private:
+            int subscribe();
+
+            /* 处理一条订阅消息, return 1 本主节点发生了切换 */
+            int handle_message(const redisReply *reply);
+
+            std::vector< std::pair<std::string, int> > sentinels_;
+            std::string                     master_name_;
+            PRedisSentinelOptions           options_;
+            std::shared_ptr<PRedisEndpoint> endpoint_;
+
+            std::unique_ptr<PRedisConnection> subscriber_;
+            size_t                          next_sentinel_;
+            uint64_t                        next_refresh_us_;
+            PRedisArgv                      args_;
+    };
+
+}
@@ -0,0 +1,175 @@
+/*
+ * FileName : p_redis_slowlog.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 06 Nov 2026 10:36:14 AM CST   Created
+*/
+
+#include "p_redis_slowlog.h"
+
+#include <libpc/pc_logger.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace pepper;
+
+/* 信号处理函数累加, 各 PRedisSlowlog 记录自己处理到的值 */
+static std::atomic<uint32_t> s_dump_requests(0);
+
+static void on_dump_signal(int)
+{
+    s_dump_requests.fetch_add(1, std::memory_order_relaxed);
+}
+
+PRedisSlowlog::PRedisSlowlog(const PRedisSlowlogOptions &options)
+    : options_(options), next_(0), next_id_(0), dumped_(s_dump_requests.load(std::memory_order_relaxed))
+{
+    if (0 == options_.capacity) {
+        options_.capacity = 1;
+    }
+    ring_.reserve(options_.capacity);
+}
+
+void PRedisSlowlog::add(PRedisSlowlogEntry &entry, const char *resp, size_t resp_len)
+{
+    if (entry.command.empty()) {
+        format_command(resp, resp_len, options_.max_args, options_.max_arg_len, entry.command);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry.id = next_id_++;
+    if (ring_.size() < options_.capacity) {
+        ring_.push_back(std::move(entry));
+        return;
+    }
+    ring_[next_] = std::move(entry);
+    next_ = (next_ + 1) % options_.capacity;
+}
+
+void PRedisSlowlog::entries(std::vector<PRedisSlowlogEntry> &out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = ring_.size();
+    for (size_t i = 0; i < n; ++i) {
+        /* 未满时 next_ 为 0, 最新的在末尾 */
+        out.push_back(ring_[(next_ + n - 1 - i) % n]);
+    }
+}
+
+void PRedisSlowlog::dump(std::string &out) const
+{
+    std::vector<PRedisSlowlogEntry> list;
+    entries(list);
+
+    char line[512];
+    for (auto &e : list) {
+        snprintf(line, sizeof(line),
+                 "#%llu %llu.%03llu %lluus %s fd %d %s reply %lluB",
+                 static_cast<unsigned long long>(e.id),
+                 static_cast<unsigned long long>(e.start_ms / 1000),
+                 static_cast<unsigned long long>(e.start_ms % 1000),
+                 static_cast<unsigned long long>(e.duration_us), e.endpoint.c_str(), e.fd,
+                 predis_error_name(e.error), static_cast<unsigned long long>(e.reply_bytes));
+        out += line;
+        for (int p = 0; p < PREDIS_PHASE_COUNT; ++p) {
+            if (e.phase_ns[p] > 0) {
+                snprintf(line, sizeof(line), " %s %lluus", predis_phase_name(static_cast<PRedisPhase>(p)),
+                         static_cast<unsigned long long>(e.phase_ns[p] / 1000));
+                out += line;
+            }
+        }
+        out += " | ";
+        out += e.command;
+        out += '\n';
+    }
+}
+
+void PRedisSlowlog::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_.clear();
+    next_ = 0;
+}
+
+void PRedisSlowlog::install_dump_signal(int signo)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_dump_signal;
+    sa.sa_flags   = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (0 != sigaction(signo, &sa, nullptr)) {
+        pc_log_error("slowlog: install handler for signal %d failed", signo);
+    }
+}
+
+void PRedisSlowlog::poll_dump()
+{
+    uint32_t requested = s_dump_requests.load(std::memory_order_relaxed);
+    uint32_t dumped = dumped_.load(std::memory_order_relaxed);
+    if (requested == dumped || !dumped_.compare_exchange_strong(dumped, requested)) {
+        return;
+    }
+
+    std::string out;
+    dump(out);
+    pc_log_error("redis client slowlog, threshold %lluus:\n%s",
+                 static_cast<unsigned long long>(options_.threshold_us), out.c_str());
+}
+
+/*
+ * resp 由 PRespWriter 生成, 格式可信, 这里仍按长度检查, 截断的缓冲区不会越界
+ */
+void PRedisSlowlog::format_command(const char *resp, size_t len, size_t max_args,
+                                   size_t max_arg_len, std::string &out)
+{
+    const char *p   = resp;
+    const char *end = resp + len;
+    if (p == end || *p != '*') {
+        return;
+    }
+
+    char *next = nullptr;
+    long argc = strtol(p + 1, &next, 10);
+    p = next + 2;
+
+    for (long i = 0; i < argc && p < end; ++i) {
+        if (static_cast<size_t>(i) >= max_args) {
+            char more[48];
+            snprintf(more, sizeof(more), " ... (%ld more)", argc - i);
+            out += more;
+            break;
+        }
+        if (*p != '$') {
+            return;
+        }
+        long n = strtol(p + 1, &next, 10);
+        p = next + 2;
+        if (n < 0 || p + n > end) {
+            return;
+        }
+
+        if (i > 0) {
+            out += ' ';
+        }
+        size_t shown = static_cast<size_t>(n) < max_arg_len ? static_cast<size_t>(n) : max_arg_len;
+        for (size_t j = 0; j < shown; ++j) {
+            unsigned char c = static_cast<unsigned char>(p[j]);
+            if (c >= 0x20 && c < 0x7F && c != '\\') {
+                out += static_cast<char>(c);
+            } else {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "\\x%02x", c);
+                out += hex;
+            }
+        }
+        if (shown < static_cast<size_t>(n)) {
+            char more[48];
+            snprintf(more, sizeof(more), "...(%ld bytes)", n);
+            out += more;
+        }
+        p += n + 2;
+    }
+}
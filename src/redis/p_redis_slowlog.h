@@ -0,0 +1,96 @@
+/*
+ * FileName : p_redis_slowlog.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Fri 06 Nov 2026 10:36:14 AM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "p_redis_error.h"
+#include "p_redis_phase.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pepper
+{
+
+    struct PRedisSlowlogOptions
+    {
+        uint64_t threshold_us = 10000;      /* 客户端耗时超过该值的命令才记录 */
+        size_t   capacity     = 128;        /* 环形缓冲区大小, 满了覆盖最旧的 */
+        size_t   max_args     = 8;          /* 每条命令最多记录的参数个数 */
+        size_t   max_arg_len  = 64;         /* 每个参数最多记录的字节数 */
+    };
+
+    struct PRedisSlowlogEntry
+    {
+        uint64_t    id          = 0;
+        uint64_t    start_ms    = 0;        /* 开始时的墙上时间 */
+        uint64_t    duration_us = 0;        /* 客户端看到的耗时, 包括重试 */
+        std::string command;                /* 截断后的命令和参数 */
+        std::string endpoint;
+        int         fd          = -1;
+        PRedisError error       = PREDIS_OK;
+        uint64_t    reply_bytes = 0;        /* 从 socket 读到的字节数 */
+
+        /*
+         * 各阶段纳秒数; 只有被 set_phase_sampling 采样的命令才分开统计写、等待、
+         * 解析, 其他命令这三段合计在 wait 中
+         */
+        uint64_t    phase_ns[PREDIS_PHASE_COUNT] = {};
+    };
+
+    /*
+     * @brief 客户端慢命令日志, 可由多个 PRedisClient 共享 (见 set_slowlog).
+     * 只有超过阈值的命令加锁写入, 其他命令只有一次比较
+     */
+    class PRedisSlowlog : public noncopyable
+    {
+        public:
+            explicit PRedisSlowlog(const PRedisSlowlogOptions &options = PRedisSlowlogOptions());
+
+            const PRedisSlowlogOptions &options() const { return options_; }
+
+            bool is_slow(uint64_t duration_us) const { return duration_us >= options_.threshold_us; }
+
+            /* entry.command 为空时按 options 从 resp 格式化 */
+            void add(PRedisSlowlogEntry &entry, const char *resp, size_t resp_len);
+
+            /* 从新到旧 */
+            void entries(std::vector<PRedisSlowlogEntry> &out) const;
+
+            /* 文本格式, 追加到 out */
+            void dump(std::string &out) const;
+
+            void reset();
+
+            /*
+             * @brief 安装信号处理函数 (例如 SIGUSR2), 收到信号后由下一条经过
+             * 任一客户端的命令把所有慢日志输出到日志; 处理函数只修改一个原子计数
+             */
+            static void install_dump_signal(int signo);
+
+            /* 有未处理的输出请求时输出到日志, 多个客户端共享时只输出一次 */
+            void poll_dump();
+
+            /* RESP 命令转为可读文本, 参数截断, 不可打印字符转义 */
+            static void format_command(const char *resp, size_t len, size_t max_args,
+                                       size_t max_arg_len, std::string &out);
+
+        private:
+            PRedisSlowlogOptions            options_;
+            mutable std::mutex              mutex_;
+            std::vector<PRedisSlowlogEntry> ring_;
+            size_t                          next_;
+            uint64_t                        next_id_;
+            std::atomic<uint32_t>           dumped_;
+    };
+
+}
@@ -0,0 +1,295 @@
+/*
+ * FileName : p_redis_stream.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 03:40:12 PM CST   Created
+*/
+
+#include "p_redis_stream.h"
+
+#include <libpc/pc_logger.h>
+
+#include <string.h>
+
+using namespace pepper;
+
+int pepper::parse_stream_entries(const redisReply *reply, std::vector<PRedisStreamEntry> &entries)
+{
+    if (reply->type == REDIS_REPLY_NIL) {
+        entries.clear();
+        return 0;
+    }
+    if (reply->type != REDIS_REPLY_ARRAY) {
+        return -1;
+    }
+
+    entries.resize(reply->elements);
+    for (size_t i = 0; i < reply->elements; ++i) {
+        const redisReply *item = reply->element[i];
+        if (item->type != REDIS_REPLY_ARRAY || item->elements != 2
+                || item->element[0]->type != REDIS_REPLY_STRING) {
+            return -1;
+        }
+
+        PRedisStreamEntry &entry = entries[i];
+        entry.id.assign(item->element[0]->str, item->element[0]->len);
+
+        const redisReply *fields = item->element[1];
+        if (fields->type == REDIS_REPLY_NIL) {
+            entry.fields.clear();
+            continue;
+        }
+        if (fields->type != REDIS_REPLY_ARRAY || fields->elements % 2 != 0) {
+            return -1;
+        }
+
+        entry.fields.resize(fields->elements / 2);
+        for (size_t j = 0; j < fields->elements; j += 2) {
+            const redisReply *field = fields->element[j];
+            const redisReply *value = fields->element[j+1];
+            entry.fields[j/2].first.assign(field->str, field->len);
+            entry.fields[j/2].second.assign(value->str, value->len);
+        }
+    }
+
+    return static_cast<int>(entries.size());
+}
+
+PRedisStreamConsumer::PRedisStreamConsumer(const std::string &host, int port,
+        const std::string &stream, const std::string &group, const std::string &consumer)
+    : connection_(host, port), stream_(stream), group_(group), consumer_(consumer),
+      acks_in_flight_(0), claim_cursor_("0-0")
+{
+}
+
+PRedisStreamConsumer::~PRedisStreamConsumer()
+{
+}
+
+int PRedisStreamConsumer::connect(uint32_t timeout_ms)
+{
+    acks_in_flight_ = 0;
+
+    return connection_.connect(timeout_ms);
+}
+
+void PRedisStreamConsumer::set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint)
+{
+    connection_.set_endpoint(endpoint);
+}
+
+int PRedisStreamConsumer::create_group(const std::string &start_id)
+{
+    args_.reset();
+    args_.push("XGROUP", 6);
+    args_.push("CREATE", 6);
+    args_.push(stream_);
+    args_.push(group_);
+    args_.push(start_id);
+    args_.push("MKSTREAM", 8);
+
+    PRedisReply reply = connection_.command(args_);
+    if (!reply) {
+        pc_log_error("XGROUP CREATE %s %s error: reply is nullptr", stream_.c_str(), group_.c_str());
+        return -1;
+    }
+
+    int ret = 1;
+    if (reply->type == REDIS_REPLY_ERROR) {
+        if (0 == strncmp(reply->str, "BUSYGROUP", 9)) {
+            ret = 0;
+        } else {
+            pc_log_error("XGROUP CREATE %s %s error: %s", stream_.c_str(), group_.c_str(), reply->str);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+int PRedisStreamConsumer::fetch(size_t count, int block_ms, std::vector<PRedisStreamEntry> &entries)
+{
+    return read_group(count, block_ms, ">", entries);
+}
+
+int PRedisStreamConsumer::fetch_pending(size_t count, std::vector<PRedisStreamEntry> &entries)
+{
+    return read_group(count, -1, "0", entries);
+}
+
+void PRedisStreamConsumer::ack(const std::string &id)
+{
+    acks_.push_back(id);
+}
+
+void PRedisStreamConsumer::ack(const std::vector<PRedisStreamEntry> &entries)
+{
+    for (const auto &entry : entries) {
+        acks_.push_back(entry.id);
+    }
+}
+
+int PRedisStreamConsumer::flush_acks()
+{
+    if (acks_.empty()) { return 0; }
+
+    append_acks();
+    if (acks_in_flight_ == 0) {
+        return -1;
+    }
+
+    return read_acks();
+}
+
+int PRedisStreamConsumer::claim_stale(uint64_t min_idle_ms, size_t count,
+                                      std::vector<PRedisStreamEntry> &entries)
+{
+    append_acks();
+    if (0 != connection_.set_block_timeout(-1)) {
+        return -1;
+    }
+
+    args_.reset();
+    args_.push("XAUTOCLAIM", 10);
+    args_.push(stream_);
+    args_.push(group_);
+    args_.push(consumer_);
+    args_.push(static_cast<long long>(min_idle_ms));
+    args_.push(claim_cursor_);
+    args_.push("COUNT", 5);
+    args_.push(static_cast<long long>(count));
+
+    if (0 != connection_.append(args_)) {
+        acks_in_flight_ = 0;
+        return -1;
+    }
+    if (acks_in_flight_ > 0 && read_acks() < 0 && !connection_.connected()) {
+        return -1;
+    }
+
+    PRedisReply reply;
+    if (0 != connection_.read_reply(reply)) {
+        pc_log_error("XAUTOCLAIM %s %s error: reply is nullptr", stream_.c_str(), group_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_ERROR) {
+        pc_log_error("XAUTOCLAIM %s %s error: %s", stream_.c_str(), group_.c_str(), reply->str);
+    } else if (reply->type != REDIS_REPLY_ARRAY || reply->elements < 2
+            || reply->element[0]->type != REDIS_REPLY_STRING) {
+        pc_log_error("XAUTOCLAIM %s %s error: unexpected reply", stream_.c_str(), group_.c_str());
+    } else {
+        claim_cursor_.assign(reply->element[0]->str, reply->element[0]->len);
+        ret = parse_stream_entries(reply->element[1], entries);
+        if (ret < 0) {
+            pc_log_error("XAUTOCLAIM %s %s error: malformed entries", stream_.c_str(), group_.c_str());
+        }
+    }
+
+    return ret;
+}
+
+int PRedisStreamConsumer::read_group(size_t count, int block_ms, const char *start_id,
+                                     std::vector<PRedisStreamEntry> &entries)
+{
+    append_acks();
+    if (0 != connection_.set_block_timeout(block_ms)) {
+        acks_in_flight_ = 0;
+        return -1;
+    }
+
+    args_.reset();
+    args_.push("XREADGROUP", 10);
+    args_.push("GROUP", 5);
+    args_.push(group_);
+    args_.push(consumer_);
+    args_.push("COUNT", 5);
+    args_.push(static_cast<long long>(count));
+    if (block_ms >= 0) {
+        args_.push("BLOCK", 5);
+        args_.push(static_cast<long long>(block_ms));
+    }
+    args_.push("STREAMS", 7);
+    args_.push(stream_);
+    args_.push(start_id);
+
+    if (0 != connection_.append(args_)) {
+        acks_in_flight_ = 0;
+        return -1;
+    }
+    if (acks_in_flight_ > 0 && read_acks() < 0 && !connection_.connected()) {
+        return -1;
+    }
+
+    PRedisReply reply;
+    if (0 != connection_.read_reply(reply)) {
+        pc_log_error("XREADGROUP %s %s error: reply is nullptr", stream_.c_str(), group_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_NIL) {
+        entries.clear();
+        ret = 0;
+    } else if (reply->type == REDIS_REPLY_ERROR) {
+        pc_log_error("XREADGROUP %s %s error: %s", stream_.c_str(), group_.c_str(), reply->str);
+    } else if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 1
+            || reply->element[0]->type != REDIS_REPLY_ARRAY
+            || reply->element[0]->elements != 2) {
+        pc_log_error("XREADGROUP %s %s error: unexpected reply", stream_.c_str(), group_.c_str());
+    } else {
+        ret = parse_stream_entries(reply->element[0]->element[1], entries);
+        if (ret < 0) {
+            pc_log_error("XREADGROUP %s %s error: malformed entries", stream_.c_str(), group_.c_str());
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * 所有待确认的ID合并为一条 XACK 追加到输出缓冲, 与随后的命令一起写出.
+ * 连接异常时这些ID会丢失, 但消息仍在 PEL 中, 之后可以通过
+ * claim_stale() 重新投递, 不影响 at-least-once 语义.
+ */
+void PRedisStreamConsumer::append_acks()
+{
+    if (acks_.empty() || acks_in_flight_ > 0) { return; }
+
+    args_.reset();
+    args_.push("XACK", 4);
+    args_.push(stream_);
+    args_.push(group_);
+    for (const auto &id : acks_) {
+        args_.push(id);
+    }
+
+    if (0 != connection_.append(args_)) {
+        pc_log_error("XACK %s %s error: append failed", stream_.c_str(), group_.c_str());
+        return;
+    }
+
+    acks_in_flight_ = acks_.size();
+    acks_.clear();
+}
+
+int PRedisStreamConsumer::read_acks()
+{
+    acks_in_flight_ = 0;
+
+    PRedisReply reply;
+    if (0 != connection_.read_reply(reply)) {
+        pc_log_error("XACK %s %s error: reply is nullptr", stream_.c_str(), group_.c_str());
+        return -1;
+    }
+
+    int ret = -1;
+    if (reply->type == REDIS_REPLY_INTEGER) {
+        ret = static_cast<int>(reply->integer);
+    } else {
+        pc_log_error("XACK %s %s error: %s", stream_.c_str(), group_.c_str(),
+                     reply->type == REDIS_REPLY_ERROR ? reply->str : "type is not REDIS_REPLY_INTEGER");
+    }
+
+    return ret;
+}
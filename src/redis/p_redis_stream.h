@@ -0,0 +1,153 @@
+/*
+ * FileName : p_redis_stream.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Mon 19 Oct 2026 03:40:12 PM CST   Created
+*/
+
+#pragma once
+
+#include "non_copyable.h"
+#include "hiredis.h"
+#include "p_redis_connection.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <stdint.h>
+
+namespace pepper
+{
+
+    /*
+     * Stream 中的一条消息
+     * fields 为空表示该消息已被 XDEL/XTRIM 删除, 但仍在 PEL 中
+     */
+    struct PRedisStreamEntry
+    {
+        std::string id;
+        std::vector< std::pair<std::string, std::string> > fields;
+    };
+
+    /*
+     * XPENDING key group 的汇总结果
+     */
+    struct PRedisStreamPendingSummary
+    {
+        long long   count;
+        std::string min_id;
+        std::string max_id;
+        std::vector< std::pair<std::string, long long> > consumers;
+    };
+
+    /*
+     * XPENDING key group [IDLE min-idle] start end count 的单条结果
+     */
+    struct PRedisStreamPendingEntry
+    {
+        std::string id;
+        std::string consumer;
+        long long   idle_ms;
+        long long   deliveries;
+    };
+
+    /*
+     * @brief 解析 [[id, [field, value, ...]], ...] 格式的消息数组
+     * entries 中已有的元素会被复用, 以减少批量读取时的内存分配
+     * @return >=0 消息数量
+     *         -1 格式错误
+     */
+    int parse_stream_entries(const redisReply *reply, std::vector<PRedisStreamEntry> &entries);
+
+    /*
+     * @brief Stream 消费组的消费者
+     *
+     * 每个消费者独占一条连接, XREADGROUP BLOCK 只阻塞这条连接(在 libpc
+     * 中只挂起调用的协程), 不会占用 PRedisClient 的连接.
+     * ack() 只是把ID放入待确认队列, 下一次 fetch() 时 XACK 与 XREADGROUP
+     * 合并为一次写操作发出, 一个批次只需一次网络往返.
+     */
+    class PRedisStreamConsumer : public noncopyable
+    {
+        public:
+            PRedisStreamConsumer(const std::string &host, int port,
+                                 const std::string &stream, const std::string &group,
+                                 const std::string &consumer);
+            ~PRedisStreamConsumer();
+
+            /*
+             * @brief 建立连接, timeout_ms 为连接及读写超时
+             * 之后连接异常会在下一次调用时自动重连
+             * return 0 成功 -1 失败
+             */
+            int connect(uint32_t timeout_ms);
+
+            /*
+             * @brief 跟随 endpoint 的地址 (一般来自 PRedisSentinel),
+             * 地址变化后下一次 fetch 或其他命令前切换
+             */
+            void set_endpoint(const std::shared_ptr<PRedisEndpoint> &endpoint);
+
+            /*
+             * @brief XGROUP CREATE stream group start_id MKSTREAM
+             * return 1 创建成功
+             *        0 消费组已存在
+             *       -1 异常
+             */
+            int create_group(const std::string &start_id = "$");
+
+            /*
+             * @brief 批量读取新消息, 同时发出所有待确认的 XACK
+             * @param count    单次最多读取的条数
+             * @param block_ms <0 不阻塞, 0 一直阻塞, >0 最多阻塞的毫秒数
+             * return >=0 读到的消息数(超时返回0)
+             *         -1 异常, 此时 entries 的内容无意义
+             */
+            int fetch(size_t count, int block_ms, std::vector<PRedisStreamEntry> &entries);
+
+            /*
+             * @brief 读取本消费者已投递但未确认的消息(崩溃恢复时使用)
+             * return >=0 消息数 -1 异常
+             */
+            int fetch_pending(size_t count, std::vector<PRedisStreamEntry> &entries);
+
+            /*
+             * @brief 标记消息已处理, 在下一次 fetch() 或 flush_acks() 时发出
+             */
+            void ack(const std::string &id);
+            void ack(const std::vector<PRedisStreamEntry> &entries);
+
+            /*
+             * @brief 立即发出待确认的 XACK
+             * return >=0 确认成功的条数 -1 异常
+             */
+            int flush_acks();
+
+            /*
+             * @brief XAUTOCLAIM 接管空闲超过 min_idle_ms 的消息
+             * 内部保存游标, 多次调用会依次扫描整个 PEL
+             * return >=0 接管的消息数 -1 异常
+             */
+            int claim_stale(uint64_t min_idle_ms, size_t count,
+                            std::vector<PRedisStreamEntry> &entries);
+
+            size_t pending_acks() const { return acks_.size(); }
+
+        private:
+            int read_group(size_t count, int block_ms, const char *start_id,
+                           std::vector<PRedisStreamEntry> &entries);
+            void append_acks();
+            int read_acks();
+
+            PRedisConnection connection_;
+            std::string      stream_;
+            std::string      group_;
+            std::string      consumer_;
+
+            std::vector<std::string> acks_;
+            size_t                   acks_in_flight_;
+            std::string              claim_cursor_;
+            PRedisArgv               args_;
+    };
+
+}
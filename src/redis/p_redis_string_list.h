@@ -0,0 +1,176 @@
+/*
+ * FileName : p_redis_string_list.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 07:36:52 PM CST   Created
+*/
+
+#pragma once
+
+#include "hiredis.h"
+#include "p_string_ref.h"
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+
+namespace pepper
+{
+
+    /*
+     * @brief 多条回复(multi-bulk)的扁平存储
+     *
+     * 所有元素依次拷贝到一块连续内存, 另有一个偏移数组, 第 i 个元素为
+     * [offsets_[i], offsets_[i+1]). 整个回复只有这两次分配, 而不是每个元素
+     * 一个 std::string; clear() 后容量保留, 重复使用时没有分配.
+     * 元素以 PStringRef 返回, 在下一次修改列表之前有效.
+     * NIL 元素存为空串; HGETALL 的结果按 field, value 交替存放.
+     *
+     * Chars/Offsets 为 char/size_t 的 vector 类型, 一般使用下面的
+     * PRedisStringList 或 pmr::PRedisStringList.
+     */
+    template <typename Chars, typename Offsets>
+    class PBasicRedisStringList
+    {
+        public:
+            typedef typename Chars::allocator_type allocator_type;
+
+            class const_iterator
+            {
+                public:
+                    /* 元素按值返回, operator-> 通过持有 PStringRef 的代理对象实现 */
+                    class pointer
+                    {
+                        public:
+                            explicit pointer(PStringRef ref) : ref_(ref) {}
+                            const PStringRef *operator->() const { return &ref_; }
+
+                        private:
+                            PStringRef ref_;
+                    };
+
+                    typedef std::random_access_iterator_tag iterator_category;
+                    typedef PStringRef value_type;
+                    typedef ptrdiff_t  difference_type;
+                    typedef PStringRef reference;
+
+                    const_iterator() : list_(nullptr), index_(0) {}
+                    const_iterator(const PBasicRedisStringList *list, size_t index)
+                        : list_(list), index_(index) {}
+
+                    PStringRef operator*() const { return (*list_)[index_]; }
+                    pointer operator->() const { return pointer((*list_)[index_]); }
+                    PStringRef operator[](difference_type n) const { return (*list_)[index_ + n]; }
+
+                    const_iterator &operator++() { ++index_; return *this; }
+                    const_iterator operator++(int) { const_iterator it = *this; ++index_; return it; }
+                    const_iterator &operator--() { --index_; return *this; }
+                    const_iterator operator--(int) { const_iterator it = *this; --index_; return it; }
+                    const_iterator &operator+=(difference_type n) { index_ += n; return *this; }
+                    const_iterator &operator-=(difference_type n) { index_ -= n; return *this; }
+                    const_iterator operator+(difference_type n) const { return const_iterator(list_, index_ + n); }
+                    const_iterator operator-(difference_type n) const { return const_iterator(list_, index_ - n); }
+                    friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+                    difference_type operator-(const const_iterator &other) const
+                    {
+                        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+                    }
+
+                    bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+                    bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+                    bool operator<(const const_iterator &other) const { return index_ < other.index_; }
+                    bool operator>(const const_iterator &other) const { return index_ > other.index_; }
+                    bool operator<=(const const_iterator &other) const { return index_ <= other.index_; }
+                    bool operator>=(const const_iterator &other) const { return index_ >= other.index_; }
+
+                private:
+                    const PBasicRedisStringList *list_;
+                    size_t                       index_;
+            };
+
+            explicit PBasicRedisStringList(const allocator_type &alloc = allocator_type())
+                : data_(alloc), offsets_(typename Offsets::allocator_type(alloc))
+            {
+                offsets_.push_back(0);
+            }
+
+            size_t size() const { return offsets_.size() - 1; }
+            bool empty() const { return offsets_.size() == 1; }
+
+            /* 所有元素的总字节数 */
+            size_t bytes() const { return data_.size(); }
+
+            PStringRef operator[](size_t i) const
+            {
+                return PStringRef(data_.data() + offsets_[i], offsets_[i+1] - offsets_[i]);
+            }
+
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, size()); }
+
+            void clear()
+            {
+                data_.clear();
+                offsets_.resize(1);
+            }
+
+            void reserve(size_t count, size_t bytes)
+            {
+                data_.reserve(data_.size() + bytes);
+                offsets_.reserve(offsets_.size() + count);
+            }
+
+            void push_back(PStringRef value)
+            {
+                data_.insert(data_.end(), value.data(), value.data() + value.size());
+                offsets_.push_back(data_.size());
+            }
+
+            /*
+             * @brief 把数组回复的元素追加到末尾, 先按总长度一次性预留内存
+             * return 追加的元素个数
+             */
+            size_t append(const redisReply *r)
+            {
+                size_t bytes = 0;
+                for (size_t i = 0; i < r->elements; ++i) {
+                    bytes += r->element[i]->len;
+                }
+                reserve(r->elements, bytes);
+
+                for (size_t i = 0; i < r->elements; ++i) {
+                    const redisReply *item = r->element[i];
+                    if (item->type == REDIS_REPLY_STRING || item->type == REDIS_REPLY_STATUS) {
+                        push_back(PStringRef(item->str, item->len));
+                    } else {
+                        push_back(PStringRef());
+                    }
+                }
+
+                return r->elements;
+            }
+
+        private:
+            Chars   data_;
+            Offsets offsets_;
+    };
+
+    typedef PBasicRedisStringList<std::vector<char>, std::vector<size_t> > PRedisStringList;
+
+#if __cplusplus >= 201703L
+    namespace pmr
+    {
+        /*
+         * 由调用者提供内存, 例如每个请求一个 std::pmr::monotonic_buffer_resource:
+         *   std::pmr::monotonic_buffer_resource arena(buf, sizeof(buf));
+         *   pepper::pmr::PRedisStringList values(&arena);
+         */
+        typedef PBasicRedisStringList<std::pmr::vector<char>, std::pmr::vector<size_t> > PRedisStringList;
+    }
+#endif
+
+}
@@ -0,0 +1,54 @@
+/*
+ * FileName : p_string_ref.h
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 04:12:09 PM CST   Created
+*/
+
+#pragma once
+
+#include <string>
+
+#include <string.h>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace pepper
+{
+
+    /*
+     * @brief 不持有内存的字符串引用 (C++11 下的 string_view)
+     *
+     * 可以由 std::string, const char *, (指针, 长度) 以及 C++17 的
+     * std::string_view 隐式构造, 用作 PRedisClient 的参数时直接编码进
+     * 命令缓冲区, 不会产生临时的 std::string.
+     * 内容不要求以 '\0' 结尾, 打印时使用 "%.*s".
+     */
+    class PStringRef
+    {
+        public:
+            PStringRef() : data_(""), size_(0) {}
+            PStringRef(const char *data) : data_(data), size_(strlen(data)) {}
+            PStringRef(const char *data, size_t size) : data_(data), size_(size) {}
+            PStringRef(const std::string &str) : data_(str.data()), size_(str.size()) {}
+#if __cplusplus >= 201703L
+            PStringRef(std::string_view str) : data_(str.data()), size_(str.size()) {}
+            operator std::string_view() const { return std::string_view(data_, size_); }
+#endif
+
+            const char *data() const { return data_; }
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+
+            /* 用于 "%.*s" */
+            int isize() const { return static_cast<int>(size_); }
+
+            std::string str() const { return std::string(data_, size_); }
+
+        private:
+            const char *data_;
+            size_t      size_;
+    };
+
+}
@@ -0,0 +1,96 @@
+/*
+ * FileName : p_redis_bulk_load.cpp
+ * Author   : Pengcheng Liu(Lpc-Win32)
+ * Date     : Tue 20 Oct 2026 11:36:20 AM CST   Created
+*/
+
+#include "p_redis_bulk_loader.h"
+
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace pepper;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-h host] [-p port] [-f tsv|csv|binary] [-c command]\n"
+            "          [-w window] [-b chunk_bytes] [-t timeout_ms] file...\n"
+            "  -c  command prepended to every record, default SET;\n"
+            "      use -c '' when the first field of each record is the command\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    uint32_t timeout_ms = 5000;
+    PRedisBulkLoadOptions options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:f:c:w:b:t:")) != -1) {
+        switch (opt) {
+        case 'h':
+            host = optarg;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'f':
+            if (0 == strcmp(optarg, "csv")) {
+                options.format = PRedisBulkLoadOptions::FORMAT_CSV;
+            } else if (0 == strcmp(optarg, "binary")) {
+                options.format = PRedisBulkLoadOptions::FORMAT_BINARY;
+            } else if (0 == strcmp(optarg, "tsv")) {
+                options.format = PRedisBulkLoadOptions::FORMAT_TSV;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'c':
+            options.command = optarg;
+            break;
+        case 'w':
+            options.window = strtoul(optarg, nullptr, 10);
+            break;
+        case 'b':
+            options.chunk_bytes = strtoul(optarg, nullptr, 10);
+            break;
+        case 't':
+            timeout_ms = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    PRedisBulkLoader loader(host, port, options);
+    if (0 != loader.connect(timeout_ms)) {
+        fprintf(stderr, "connect %s:%d failed\n", host.c_str(), port);
+        return 1;
+    }
+
+    PRedisBulkLoadReport report;
+    int ret = 0;
+    for (int i = optind; i < argc; ++i) {
+        if (0 != loader.load_file(argv[i], report)) {
+            fprintf(stderr, "load %s failed\n", argv[i]);
+            ret = 1;
+            break;
+        }
+    }
+    report.print(stdout);
+
+    return (ret != 0 || report.errors > 0 || report.bad_records > 0) ? 1 : 0;
+}